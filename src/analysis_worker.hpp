@@ -0,0 +1,162 @@
+#pragma once
+
+#include "board.hpp"
+#include "heatmap_cache.hpp"
+#include "position_analysis.hpp"
+#include "profiler.hpp"
+#include "triple_buffer.hpp"
+#include "work_stealing.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// ============================================================================
+// AnalysisWorker — computes PositionAnalysis on a background thread.
+//
+// The UI thread submits positions and picks up results; positions and
+// results each travel through a TripleBuffer, so neither thread blocks on
+// the other. Every submit gets a new generation number. A result whose
+// generation has been superseded by the time it is finished is dropped
+// rather than published, and the UI only accepts the result for its latest
+// submit.
+//
+// A submit can also ask for a look-ahead pressure map. The rest of the
+// analysis is published first; the same result is published again with the
+// map once the search finishes. The search gives up as soon as a newer
+// position is submitted.
+// ============================================================================
+
+class AnalysisWorker {
+public:
+    AnalysisWorker() { thread = std::thread([this] { run(); }); }
+
+    // Plies further ahead count for less in the pressure map
+    static constexpr double PRESSURE_DECAY = 0.75;
+
+    ~AnalysisWorker() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            quit.store(true, std::memory_order_relaxed);
+        }
+        wake.notify_one();
+        thread.join();
+    }
+
+    AnalysisWorker(const AnalysisWorker&) = delete;
+    AnalysisWorker& operator=(const AnalysisWorker&) = delete;
+
+    // UI thread: analyse this position next, replacing any submit the worker
+    // has not started yet. heat, if given, are the position's heat maps;
+    // pressureDepth > 0 adds a pressure map that many plies deep.
+    void submit(const Board& board, const PackedHeatMaps* heat = nullptr, int pressureDepth = 0) {
+        Request& request = requests.writeBuffer();
+        request.generation = ++lastSubmitted;
+        request.board = board;
+        request.hasHeat = (heat != nullptr);
+        if (heat) request.heat = *heat;
+        request.pressureDepth = pressureDepth;
+
+        // submitted goes up before the request is handed over. The other
+        // order lets the worker finish the new request while submitted still
+        // names the old one: publish() drops the result, and once submitted
+        // catches up it equals done, so the worker sleeps without one. This
+        // way a worker that looks too early only sees its old request again,
+        // and keeps looking while submitted != done.
+        {
+            // The lock only orders this wake-up against the worker going to
+            // sleep; the position itself is handed over below
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            submitted.store(lastSubmitted, std::memory_order_release);
+        }
+        requests.publish();
+        wake.notify_one();
+    }
+
+    // UI thread: analysis of the last submitted position, or nullptr while
+    // it is still being computed. Its hasPressure turns true when a
+    // requested pressure map is done.
+    const PositionAnalysis* latest() {
+        results.update();
+        const Result& result = results.readBuffer();
+        return (lastSubmitted && result.generation == lastSubmitted) ? &result.analysis : nullptr;
+    }
+
+private:
+    struct Request {
+        uint64_t generation = 0;
+        Board board;
+        PackedHeatMaps heat;
+        bool hasHeat = false;
+        int pressureDepth = 0;
+    };
+
+    struct Result {
+        uint64_t generation = 0;
+        PositionAnalysis analysis;
+    };
+
+    void run() {
+        PROFILE_THREAD("analysis");
+        uint64_t done = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                wake.wait(lock, [&] {
+                    return quit.load(std::memory_order_relaxed)
+                        || submitted.load(std::memory_order_acquire) != done;
+                });
+                if (quit.load(std::memory_order_relaxed)) return;
+            }
+
+            requests.update();
+            const Request& request = requests.readBuffer();
+            if (request.generation == done) {
+                // Woken between submit()'s two steps; the request follows
+                std::this_thread::yield();
+                continue;
+            }
+            done = request.generation;
+
+            working.analyze(request.board, request.hasHeat ? &request.heat : nullptr);
+            if (!publish(request.generation) || request.pressureDepth <= 0) continue;
+
+            auto superseded = [&] {
+                return quit.load(std::memory_order_relaxed)
+                    || submitted.load(std::memory_order_acquire) != request.generation;
+            };
+            PROFILE_SCOPE("PressureSearch::compute");
+            if (!pressureSearch.compute(request.board, request.pressureDepth, PRESSURE_DECAY,
+                                        defaultThreadCount(), working.pressure, superseded))
+                continue;
+            working.hasPressure = true;
+            publish(request.generation);
+        }
+    }
+
+    // Hand working to the UI, unless the user moved on while it was computed
+    bool publish(uint64_t generation) {
+        if (submitted.load(std::memory_order_acquire) != generation) return false;
+        Result& result = results.writeBuffer();
+        result.analysis = working;
+        result.generation = generation;
+        results.publish();
+        return true;
+    }
+
+    TripleBuffer<Request> requests; // UI -> worker
+    TripleBuffer<Result> results;   // worker -> UI
+    uint64_t lastSubmitted = 0;     // UI thread only
+    std::atomic<uint64_t> submitted{0};
+
+    PositionAnalysis working;       // worker thread only
+    PressureSearch pressureSearch;  // worker thread only
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::atomic<bool> quit{false};  // set under wakeMutex
+
+    std::thread thread;             // last, so it starts after everything above
+};
@@ -0,0 +1,190 @@
+#include "board.hpp"
+#include "pgn.hpp"
+#include "work_stealing.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ============================================================================
+// batch — aggregate square-control statistics over PGN game databases
+//
+//   batch [--threads N] [--max-ply N] [-o out.csv] games.pgn...
+//
+// Every game is replayed through Board::makeMove and the attack and defense
+// counts of each position are summed per ply, per side and per opening
+// (ECO tag). Input files are memory-mapped and scanned in place: one thread
+// splits the file into games while the others replay them, each worker
+// filling its own accumulator. The accumulators are reduced at the end.
+// ============================================================================
+
+struct SquareTotals {
+    uint64_t positions = 0;
+    uint64_t attack[2][64] = {};  // indexed by Color, then square
+    uint64_t defense[2][64] = {};
+
+    void add(const Board& board) {
+        positions++;
+        for (int side = WHITE; side <= BLACK; side++) {
+            const auto& counts = board.attackCount[side];
+            Bitboard own = board.colors[side];
+            for (int sq = 0; sq < 64; sq++) {
+                attack[side][sq] += counts[sq];
+                if (own & squareBit(sq)) defense[side][sq] += counts[sq];
+            }
+        }
+    }
+
+    void merge(const SquareTotals& other) {
+        positions += other.positions;
+        for (int side = WHITE; side <= BLACK; side++)
+            for (int sq = 0; sq < 64; sq++) {
+                attack[side][sq] += other.attack[side][sq];
+                defense[side][sq] += other.defense[side][sq];
+            }
+    }
+};
+
+// Per-worker results, padded so neighbouring workers never share a line
+struct alignas(64) HeatAccumulator {
+    std::vector<SquareTotals> perPly; // index 0 is the starting position
+    std::map<std::string, SquareTotals, std::less<>> perOpening;
+    uint64_t games = 0;
+    uint64_t rejected = 0; // games cut short by an unreadable or illegal move
+
+    explicit HeatAccumulator(int maxPly) : perPly(maxPly + 1) {}
+
+    void merge(const HeatAccumulator& other) {
+        for (size_t ply = 0; ply < perPly.size(); ply++)
+            perPly[ply].merge(other.perPly[ply]);
+        for (auto& [opening, totals] : other.perOpening)
+            perOpening[opening].merge(totals);
+        games += other.games;
+        rejected += other.rejected;
+    }
+};
+
+SquareTotals& openingTotals(HeatAccumulator& acc, std::string_view eco) {
+    if (eco.empty()) eco = "?";
+    auto it = acc.perOpening.find(eco);
+    if (it == acc.perOpening.end())
+        it = acc.perOpening.emplace(std::string(eco), SquareTotals()).first;
+    return it->second;
+}
+
+void replayGame(std::string_view game, HeatAccumulator& acc) {
+    Board board;
+    std::string_view fen = pgnTag(game, "FEN");
+    if (!fen.empty() && !board.loadFEN(std::string(fen))) {
+        acc.rejected++;
+        return;
+    }
+
+    SquareTotals& opening = openingTotals(acc, pgnTag(game, "ECO"));
+    int maxPly = static_cast<int>(acc.perPly.size()) - 1;
+
+    acc.games++;
+    SanTokenizer tokens(game);
+    std::string_view san;
+    UndoInfo undo;
+    for (int ply = 0; ; ply++) {
+        if (ply <= maxPly) acc.perPly[ply].add(board);
+        opening.add(board);
+        if (!tokens.next(san)) break;
+
+        Move m;
+        if (!sanToMove(board, san, m)) {
+            acc.rejected++;
+            break;
+        }
+        board.makeMove(m, undo);
+    }
+}
+
+void writeRow(std::ostream& out, const std::string& section, const std::string& key,
+              const SquareTotals& totals) {
+    const char* sideNames[2] = {"white", "black"};
+    for (int side = WHITE; side <= BLACK; side++)
+        for (int kind = 0; kind < 2; kind++) {
+            const uint64_t* values = kind ? totals.defense[side] : totals.attack[side];
+            out << section << ',' << key << ',' << sideNames[side] << ','
+                << (kind ? "defense" : "attack") << ',' << totals.positions;
+            for (int sq = 0; sq < 64; sq++) out << ',' << values[sq];
+            out << '\n';
+        }
+}
+
+// One CSV: each row is a per-square sum over `positions` positions
+void writeCsv(std::ostream& out, const HeatAccumulator& acc) {
+    out << "section,key,side,kind,positions";
+    for (int sq = 0; sq < 64; sq++) out << ',' << squareName(sq / 8, sq % 8);
+    out << '\n';
+    for (size_t ply = 0; ply < acc.perPly.size(); ply++)
+        if (acc.perPly[ply].positions)
+            writeRow(out, "ply", std::to_string(ply), acc.perPly[ply]);
+    for (auto& [opening, totals] : acc.perOpening)
+        writeRow(out, "opening", opening, totals);
+}
+
+int main(int argc, char** argv) {
+    int threads = defaultThreadCount();
+    int maxPly = 200;
+    std::string outPath;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--max-ply" && i + 1 < argc) maxPly = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "-o" && i + 1 < argc) outPath = argv[++i];
+        else inputs.push_back(arg);
+    }
+    if (inputs.empty()) {
+        std::cerr << "usage: batch [--threads N] [--max-ply N] [-o out.csv] games.pgn..."
+                  << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<HeatAccumulator> workers(threads, HeatAccumulator(maxPly));
+
+    for (auto& path : inputs) {
+        MappedFile file;
+        if (!file.open(path)) {
+            std::cerr << "Failed to read " << path << std::endl;
+            return 1;
+        }
+        streamPgnGames(file.data(), threads, [&](std::string_view game, int w) {
+            replayGame(game, workers[w]);
+        });
+    }
+
+    HeatAccumulator total(maxPly);
+    for (auto& acc : workers) total.merge(acc);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (outPath.empty()) {
+        writeCsv(std::cout, total);
+    } else {
+        std::ofstream out(outPath);
+        if (!out) {
+            std::cerr << "Failed to write " << outPath << std::endl;
+            return 1;
+        }
+        writeCsv(out, total);
+    }
+
+    uint64_t positions = 0;
+    for (auto& [opening, totals] : total.perOpening) positions += totals.positions;
+    std::cerr << total.games << " games, " << positions << " positions, "
+              << total.rejected << " cut short, " << elapsed << " s ("
+              << static_cast<uint64_t>(positions / (elapsed > 0 ? elapsed : 1e-9))
+              << " positions/s)" << std::endl;
+    return 0;
+}
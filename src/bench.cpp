@@ -0,0 +1,415 @@
+#include "board.hpp"
+#include "heatmap_color.hpp"
+#include "pressure.hpp"
+
+#ifdef CHESS_BENCH_RENDER
+#include "position_analysis.hpp"
+#include "renderer.hpp"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// bench — microbenchmarks for the rules code and the renderer
+//
+//   bench [--filter TEXT] [--min-time MS] [-o results.json]
+//
+// Each benchmark runs over a fixed set of positions and is repeated until it
+// has taken at least --min-time. Results go to stdout (or -o) as JSON with
+// ns/op and heap allocations/op, so two builds can be compared; a readable
+// table goes to stderr. Built with -DCHESS_BENCH_RENDER (make bench-render)
+// it also times offscreen frames of the Renderer through sf::RenderTexture.
+// ============================================================================
+
+// ---------------------------------------------------------------------------
+// Allocation counting: every global operator new bumps one counter
+// ---------------------------------------------------------------------------
+
+std::atomic<uint64_t> allocCount{0};
+
+void* operator new(std::size_t size) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+// Keeps a result alive so the compiler can't drop the work producing it
+template <class T>
+inline void keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Positions
+// ---------------------------------------------------------------------------
+
+struct BenchPosition {
+    const char* name;
+    const char* fen;
+};
+
+const BenchPosition POSITIONS[] = {
+    {"opening",    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"},
+    {"middlegame", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"},
+    {"endgame",    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"},
+};
+
+// ---------------------------------------------------------------------------
+// Runner
+// ---------------------------------------------------------------------------
+
+struct BenchResult {
+    std::string name;
+    std::string position;
+    uint64_t iterations;
+    double nsPerOp;
+    double allocsPerOp;
+};
+
+struct BenchRunner {
+    std::string filter;
+    double minTimeNs = 200e6;
+    std::vector<BenchResult> results;
+
+    bool selected(const std::string& name) const {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    // body(n) performs n operations. The count is grown until one run takes
+    // at least minTimeNs; that last run is the one reported.
+    template <class Body>
+    void run(const std::string& name, const std::string& position, Body&& body) {
+        if (!selected(name + "/" + position)) return;
+
+        body(1); // warm caches and any lazily built tables
+        uint64_t n = 1;
+        for (;;) {
+            uint64_t allocsBefore = allocCount.load(std::memory_order_relaxed);
+            auto start = std::chrono::steady_clock::now();
+            body(n);
+            double ns = std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - start).count();
+            uint64_t allocs = allocCount.load(std::memory_order_relaxed) - allocsBefore;
+
+            if (ns >= minTimeNs) {
+                results.push_back({name, position, n, ns / n, double(allocs) / n});
+                const BenchResult& r = results.back();
+                std::cerr << std::left << std::setw(34) << r.name << std::setw(12) << r.position
+                          << std::right << std::setw(12) << std::fixed << std::setprecision(1)
+                          << r.nsPerOp << " ns/op" << std::setw(10) << std::setprecision(2)
+                          << r.allocsPerOp << " allocs/op" << std::endl;
+                return;
+            }
+            // Aim 20% past the target, growing at least 2x and at most 100x
+            double scale = ns > 0 ? minTimeNs * 1.2 / ns : 100.0;
+            n = static_cast<uint64_t>(n * std::max(2.0, std::min(100.0, scale)));
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Rules benchmarks
+// ---------------------------------------------------------------------------
+
+bool benchRules(BenchRunner& runner, const BenchPosition& pos) {
+    Board board;
+    if (!board.loadFEN(pos.fen)) {
+        std::cerr << "Invalid FEN for " << pos.name << ": " << pos.fen << std::endl;
+        return false;
+    }
+
+    std::vector<int> own; // squares holding a piece of the side to move
+    for (int sq = 0; sq < 64; sq++)
+        if (pieceColor(board.squares[sq / 8][sq % 8]) == board.sideToMove) own.push_back(sq);
+    MoveList legal;
+    board.getAllLegalMoves(legal);
+
+    // One op is one square/color query, cycling over all 128
+    runner.run("isSquareAttackedBy", pos.name, [&](uint64_t n) {
+        unsigned hits = 0;
+        for (uint64_t i = 0; i < n; i++) {
+            int sq = static_cast<int>(i & 63);
+            hits += board.isSquareAttackedBy(sq / 8, sq % 8, static_cast<Color>((i >> 6) & 1));
+        }
+        keep(hits);
+    });
+
+    // One op is one piece's pseudo-legal moves, into a reused list
+    runner.run("generatePieceMoves", pos.name, [&](uint64_t n) {
+        MoveList moves;
+        for (uint64_t i = 0; i < n; i++) {
+            int sq = own[i % own.size()];
+            moves.clear();
+            board.generatePieceMoves(sq / 8, sq % 8, moves);
+            keep(moves.data());
+        }
+    });
+
+    runner.run("getLegalMoves", pos.name, [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            int sq = own[i % own.size()];
+            MoveList moves;
+            board.getLegalMoves(sq / 8, sq % 8, moves);
+            keep(moves.data());
+        }
+    });
+
+    runner.run("getAllLegalMoves", pos.name, [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            MoveList moves;
+            board.getAllLegalMoves(moves);
+            keep(moves.data());
+        }
+    });
+
+    runner.run("hasAnyLegalMove", pos.name, [&](uint64_t n) {
+        unsigned any = 0;
+        for (uint64_t i = 0; i < n; i++) any += board.hasAnyLegalMove();
+        keep(any);
+    });
+
+    // Search-style: play and take back in place, cycling over the legal moves
+    runner.run("makeMove+unmakeMove", pos.name, [&](uint64_t n) {
+        Board b = board;
+        UndoInfo undo;
+        for (uint64_t i = 0; i < n; i++) {
+            Move m = legal[i % legal.size()];
+            b.makeMove(m, undo);
+            keep(b.key);
+            b.unmakeMove(m, undo);
+        }
+    });
+
+    // UI-style: copy the position and play the move, including the check for
+    // mate or stalemate afterwards
+    runner.run("makeMove", pos.name, [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) {
+            Board b = board;
+            b.makeMove(legal[i % legal.size()]);
+            keep(b);
+        }
+    });
+
+    runner.run("getAttackCounts", pos.name, [&](uint64_t n) {
+        std::array<std::array<int,8>,8> white, black;
+        for (uint64_t i = 0; i < n; i++) {
+            board.getAttackCounts(white, black);
+            keep(white);
+            keep(black);
+        }
+    });
+
+    runner.run("getDefenseCounts", pos.name, [&](uint64_t n) {
+        std::array<std::array<int,8>,8> white, black;
+        for (uint64_t i = 0; i < n; i++) {
+            board.getDefenseCounts(white, black);
+            keep(white);
+            keep(black);
+        }
+    });
+
+    // The pressure view's default depth, on one thread
+    runner.run("PressureSearch/3", pos.name, [&](uint64_t n) {
+        PressureSearch search;
+        PressureMap map;
+        for (uint64_t i = 0; i < n; i++) {
+            search.compute(board, 3, 0.75, 1, map, [] { return false; });
+            keep(map);
+        }
+    });
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Rendering benchmarks (make bench-render)
+// ---------------------------------------------------------------------------
+
+#ifdef CHESS_BENCH_RENDER
+
+const char* viewModeName(ViewMode mode) {
+    switch (mode) {
+        case VIEW_ATTACK:   return "attack";
+        case VIEW_DEFENDER: return "defender";
+        case VIEW_PRESSURE: return "pressure";
+        default:            return "normal";
+    }
+}
+
+bool benchRender(BenchRunner& runner) {
+    Renderer renderer;
+    if (!renderer.loadAssets()) {
+        std::cerr << "Failed to load assets. Run from project root." << std::endl;
+        return false;
+    }
+    sf::RenderTexture target;
+    if (!target.resize({static_cast<unsigned>(Renderer::BOARD_PX),
+                        static_cast<unsigned>(Renderer::BOARD_PX + Renderer::STATUS_HEIGHT)})) {
+        std::cerr << "Failed to create the offscreen render target" << std::endl;
+        return false;
+    }
+
+    const size_t count = sizeof(POSITIONS) / sizeof(POSITIONS[0]);
+    std::vector<Board> boards(count);
+    std::vector<PositionAnalysis> analyses(count);
+    for (size_t i = 0; i < count; i++) {
+        if (!boards[i].loadFEN(POSITIONS[i].fen)) {
+            std::cerr << "Invalid FEN for " << POSITIONS[i].name << ": " << POSITIONS[i].fen
+                      << std::endl;
+            return false;
+        }
+        analyses[i].analyze(boards[i]);
+    }
+    const MoveList noMoves;
+
+    auto frame = [&](size_t i, ViewMode mode) {
+        target.clear();
+        renderer.drawScene(target, boards[i], &analyses[i], mode, -1, -1, noMoves,
+                           false, 0.f, 0.f);
+        renderer.drawStatusBar(target, boards[i], &analyses[i], mode, 0, 0);
+        target.display();
+    };
+    // Draw calls only queue GPU work; reading the result back once at the end
+    // of a run waits for all of it, so the average covers the whole frame
+    auto finish = [&] {
+        sf::Image image = target.getTexture().copyToImage();
+        keep(image);
+    };
+
+    for (ViewMode mode : {VIEW_NORMAL, VIEW_ATTACK, VIEW_DEFENDER}) {
+        std::string name = std::string("frame/") + viewModeName(mode);
+
+        // Same position every frame: the renderer's cached layers are reused
+        for (size_t p = 0; p < count; p++) {
+            runner.run(name, POSITIONS[p].name, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; i++) frame(p, mode);
+                finish();
+            });
+        }
+
+        // A different position every frame: layers are rebuilt each time
+        runner.run(name + "+rebuild", "all", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) frame(i % count, mode);
+            finish();
+        });
+    }
+    return true;
+}
+
+#endif
+
+// ---------------------------------------------------------------------------
+// JSON output
+// ---------------------------------------------------------------------------
+
+std::string jsonString(const std::string& s) {
+    std::string out = "\"";
+    for (char ch : s) {
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += ch;
+        } else if (static_cast<unsigned char>(ch) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", ch);
+            out += buf;
+        } else {
+            out += ch;
+        }
+    }
+    return out + "\"";
+}
+
+void writeJson(std::ostream& out, const BenchRunner& runner) {
+#if defined(__VERSION__)
+    const char* compiler = __VERSION__;
+#else
+    const char* compiler = "unknown";
+#endif
+#ifdef CHESS_BENCH_RENDER
+    const bool render = true;
+#else
+    const bool render = false;
+#endif
+
+    out << "{\n"
+        << "  \"build\": {\n"
+        << "    \"compiler\": " << jsonString(compiler) << ",\n"
+        << "    \"pext\": " << (ATTACKS.usePext ? "true" : "false") << ",\n"
+        << "    \"simd\": " << jsonString(heatColorKernels().name) << ",\n"
+        << "    \"render\": " << (render ? "true" : "false") << "\n"
+        << "  },\n"
+        << "  \"min_time_ms\": " << runner.minTimeNs / 1e6 << ",\n"
+        << "  \"results\": [";
+    for (size_t i = 0; i < runner.results.size(); i++) {
+        const BenchResult& r = runner.results[i];
+        std::ostringstream line;
+        line << std::fixed << "\n    {\"name\": " << jsonString(r.name)
+             << ", \"position\": " << jsonString(r.position)
+             << ", \"iterations\": " << r.iterations
+             << ", \"ns_per_op\": " << std::setprecision(2) << r.nsPerOp
+             << ", \"allocs_per_op\": " << std::setprecision(4) << r.allocsPerOp << "}";
+        out << line.str() << (i + 1 < runner.results.size() ? "," : "");
+    }
+    out << "\n  ]\n}\n";
+}
+
+int main(int argc, char** argv) {
+    BenchRunner runner;
+    std::string outPath;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) runner.filter = argv[++i];
+        else if (arg == "--min-time" && i + 1 < argc) runner.minTimeNs = std::max(1.0, std::atof(argv[++i])) * 1e6;
+        else if (arg == "-o" && i + 1 < argc) outPath = argv[++i];
+        else {
+            std::cerr << "usage: bench [--filter TEXT] [--min-time MS] [-o results.json]" << std::endl;
+            return 1;
+        }
+    }
+
+    for (const BenchPosition& pos : POSITIONS)
+        if (!benchRules(runner, pos)) return 1;
+#ifdef CHESS_BENCH_RENDER
+    if (!benchRender(runner)) return 1;
+#endif
+
+    if (outPath.empty()) {
+        writeJson(std::cout, runner);
+    } else {
+        std::ofstream out(outPath);
+        writeJson(out, runner);
+        if (!out) {
+            std::cerr << "Failed to write " << outPath << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
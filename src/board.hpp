@@ -0,0 +1,1350 @@
+#pragma once
+
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// Piece Enum + Helpers
+// ============================================================================
+
+enum Piece : uint8_t {
+    EMPTY    = 0,
+    W_PAWN   = 1,
+    W_KNIGHT = 2,
+    W_BISHOP = 3,
+    W_ROOK   = 4,
+    W_KING   = 5,
+    W_QUEEN  = 6,
+    B_PAWN   = 7,
+    B_KNIGHT = 8,
+    B_BISHOP = 9,
+    B_ROOK   = 10,
+    B_KING   = 11,
+    B_QUEEN  = 12
+};
+
+enum Color : uint8_t { WHITE, BLACK, NONE };
+
+constexpr Color pieceColor(Piece p) {
+    if (p >= W_PAWN && p <= W_QUEEN) return WHITE;
+    if (p >= B_PAWN && p <= B_QUEEN) return BLACK;
+    return NONE;
+}
+
+inline bool isWhite(Piece p) { return pieceColor(p) == WHITE; }
+inline bool isBlack(Piece p) { return pieceColor(p) == BLACK; }
+
+// A move packed into 16 bits: from square in bits 0-5, to square in bits
+// 6-11 (index = row * 8 + col) and flags in bits 12-15, which hold the piece
+// a pawn promotes to as its white piece (W_KNIGHT..W_QUEEN), or EMPTY.
+// Castling and en passant need no flag: they are recognised on the board as
+// a king moving two files and a pawn capturing onto an empty square.
+struct Move {
+    uint16_t bits;
+
+    Move() = default; // left uninitialized, so move arrays cost nothing to create
+    constexpr Move(int from, int to, Piece promotion = EMPTY)
+        : bits(static_cast<uint16_t>(from | to << 6 | promotion << 12)) {}
+
+    constexpr int from() const { return bits & 63; }
+    constexpr int to() const { return (bits >> 6) & 63; }
+    constexpr int fromRow() const { return from() / 8; }
+    constexpr int fromCol() const { return from() % 8; }
+    constexpr int toRow() const { return to() / 8; }
+    constexpr int toCol() const { return to() % 8; }
+    constexpr Piece promotion() const { return static_cast<Piece>(bits >> 12); }
+
+    constexpr bool operator==(Move o) const { return bits == o.bits; }
+    constexpr bool operator!=(Move o) const { return bits != o.bits; }
+};
+static_assert(sizeof(Move) == 2, "Move must stay 16 bits");
+
+// Fixed-capacity list of moves, kept on the stack so generating moves never
+// touches the heap. No position has more than 218 legal moves; 256 also
+// covers the pseudo-legal moves the generator produces before filtering.
+class MoveList {
+public:
+    static constexpr size_t CAPACITY = 256;
+
+    MoveList() {} // user-provided, so the array is never zero-filled
+
+    void push_back(Move m) {
+        assert(count < CAPACITY);
+        moves[count++] = m;
+    }
+    void clear() { count = 0; }
+    void resize(size_t n) {
+        assert(n <= CAPACITY);
+        count = n;
+    }
+    template <class It>
+    void assign(It first, It last) {
+        count = 0;
+        for (; first != last; ++first) push_back(*first);
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    Move& operator[](size_t i) { return moves[i]; }
+    Move operator[](size_t i) const { return moves[i]; }
+    Move* data() { return moves; }
+    const Move* data() const { return moves; }
+    Move* begin() { return moves; }
+    Move* end() { return moves + count; }
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + count; }
+
+private:
+    Move moves[CAPACITY];
+    size_t count = 0;
+};
+
+// Algebraic square name, e.g. "e4"
+inline std::string squareName(int r, int c) {
+    return {static_cast<char>('a' + c), static_cast<char>('1' + r)};
+}
+
+// Coordinate notation as used by UCI engines and perft divide, e.g. "e2e4",
+// "e7e8q"
+inline std::string moveToUci(const Move& m) {
+    std::string uci = squareName(m.fromRow(), m.fromCol()) + squareName(m.toRow(), m.toCol());
+    if (m.promotion() != EMPTY) uci += " pnbrkq"[m.promotion()];
+    return uci;
+}
+
+// ============================================================================
+// Bitboards — one bit per square, index = row * 8 + col (a1 = 0, h8 = 63)
+// ============================================================================
+
+using Bitboard = uint64_t;
+
+constexpr int squareIndex(int r, int c) { return r * 8 + c; }
+constexpr Bitboard squareBit(int sq) { return Bitboard(1) << sq; }
+constexpr int lsb(Bitboard b) { return __builtin_ctzll(b); }
+constexpr int msb(Bitboard b) { return 63 - __builtin_clzll(b); }
+constexpr int popCount(Bitboard b) { return __builtin_popcountll(b); }
+constexpr int popLsb(Bitboard& b) { int sq = lsb(b); b &= b - 1; return sq; }
+
+// Ray directions. The first four step towards higher square indices, so the
+// nearest blocker on them is the lowest set bit; the rest use the highest.
+enum Direction { NORTH, EAST, NORTH_EAST, NORTH_WEST,
+                 SOUTH, WEST, SOUTH_WEST, SOUTH_EAST };
+
+// PEXT gathers the occupancy bits under a slider's mask into a dense table
+// index. It is emitted with inline asm so it inlines into generic code; it
+// only runs once cpuHasPext() has confirmed BMI2 support. Build with
+// -DCHESS_NO_PEXT on CPUs where PEXT is microcoded (AMD before Zen 3).
+#if !defined(CHESS_NO_PEXT) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CHESS_PEXT_AVAILABLE 1
+inline Bitboard pext(Bitboard src, Bitboard mask) {
+    Bitboard result;
+    asm("pextq %2, %1, %0" : "=r"(result) : "r"(src), "r"(mask));
+    return result;
+}
+inline bool cpuHasPext() { return __builtin_cpu_supports("bmi2"); }
+#else
+#define CHESS_PEXT_AVAILABLE 0
+inline Bitboard pext(Bitboard, Bitboard) { return 0; }
+inline bool cpuHasPext() { return false; }
+#endif
+
+// Per-square slider lookup: the relevant occupancy (mask) is hashed to an
+// index either by a magic multiply or by PEXT, and the attack set is read
+// from a table filled for that indexing scheme.
+struct SliderMagic {
+    Bitboard mask;
+    Bitboard magic;
+    const Bitboard* attacks;
+    unsigned shift;
+
+    unsigned index(Bitboard occ, bool usePext) const {
+        if (CHESS_PEXT_AVAILABLE && usePext)
+            return static_cast<unsigned>(pext(occ, mask));
+        return static_cast<unsigned>(((occ & mask) * magic) >> shift);
+    }
+};
+
+// Magic multipliers for the fancy-magic index, found offline by a sparse
+// random search: candidates are the AND of three xorshift64* outputs (seed
+// 0x9E3779B97F4A7C15) that put at least 6 bits in the top byte of
+// mask * magic, and each square takes the first one that maps its blocker
+// subsets without a destructive collision and differs from the magics of the
+// squares before it. Any set with no destructive collision
+// works; AttackTables checks for them at startup.
+const Bitboard ROOK_MAGICS[64] = {
+    0x1080004008801020ULL, 0x0840092002C03000ULL, 0x1900200010400900ULL, 0x0880100008000480ULL,
+    0x4200100420080200ULL, 0x8100020100080400ULL, 0x0200040110886200ULL, 0x0200008040220411ULL,
+    0x0404800084400220ULL, 0x0000401000402000ULL, 0x0086001081220440ULL, 0x0408800800100280ULL,
+    0x000A001201040820ULL, 0x8848800200840080ULL, 0x4001000100040200ULL, 0x0442000102105084ULL,
+    0x9080010020804100ULL, 0x0040404000201009ULL, 0x0000808010002009ULL, 0x2200090021D00100ULL,
+    0x0008008008040080ULL, 0x0004004002010040ULL, 0x0011040008015042ULL, 0x00000A0001768104ULL,
+    0x0000800080204009ULL, 0x2010004140002001ULL, 0x9800200280100080ULL, 0x1000100080080080ULL,
+    0x0442000A00049020ULL, 0x2100040080020080ULL, 0x0800120400900148ULL, 0x0010040A00128541ULL,
+    0x2800804000800030ULL, 0x1010002000400041ULL, 0x4000200011004100ULL, 0x0610008410800800ULL,
+    0x0400802402800800ULL, 0xC100020080800400ULL, 0x0002000802000401ULL, 0x0182085882000401ULL,
+    0x0220204000808000ULL, 0x2860100040024022ULL, 0x0001002004110040ULL, 0x99101042000A0020ULL,
+    0x0004080004008080ULL, 0x0010040002008080ULL, 0x2012004881020004ULL, 0x8300842444820011ULL,
+    0x0088403882010200ULL, 0x0820400080210100ULL, 0x0110910040A00300ULL, 0x0801100280080480ULL,
+    0x0242009008200600ULL, 0x1002000489500200ULL, 0x0040800200010080ULL, 0x0091800041000080ULL,
+    0x0000209300488001ULL, 0x04C1002414824001ULL, 0x020020000B001041ULL, 0x7000100004200901ULL,
+    0x8002002004100802ULL, 0x30010002084C0007ULL, 0x0888221800813004ULL, 0x4000002840840112ULL
+};
+
+const Bitboard BISHOP_MAGICS[64] = {
+    0xA010041108003100ULL, 0x006082020A002900ULL, 0x6810010619200000ULL, 0x08281A0520000408ULL,
+    0x0001104001000400ULL, 0x0018901008048400ULL, 0x00040A0210245280ULL, 0x000200210808A402ULL,
+    0x9140048410821200ULL, 0x0800091010820041ULL, 0x20504804832202C0ULL, 0x0100091401081000ULL,
+    0x8021011140000012ULL, 0x0810020804450400ULL, 0x208B0542109008A2ULL, 0x0080084A08040204ULL,
+    0x0040E2A80811244CULL, 0x2505022008008108ULL, 0x0430220100420040ULL, 0x010A040420220040ULL,
+    0x1105000290400000ULL, 0x0093001200822120ULL, 0x4000A62048043004ULL, 0x280120048A015004ULL,
+    0x006090002A020814ULL, 0x44042000240800D0ULL, 0x01102800040A4400ULL, 0x1004080080220040ULL,
+    0x0001001011004024ULL, 0x0010044000805040ULL, 0x0914041200820100ULL, 0x0004821012821480ULL,
+    0x0024040500C05021ULL, 0x0088611002080200ULL, 0x0116080A00040020ULL, 0x4000020080080080ULL,
+    0x2450450140840040ULL, 0x0000880201484100ULL, 0x0222020404020092ULL, 0x8081110600002E00ULL,
+    0x2842101105000801ULL, 0x1100809008001025ULL, 0x00020202221C0400ULL, 0x0422014022009020ULL,
+    0x0210046102100C00ULL, 0xC004008082029102ULL, 0x00AA461801101200ULL, 0x0404080080201108ULL,
+    0x020542108C205002ULL, 0x0410544804100100ULL, 0x0040910841100000ULL, 0x0400200042021100ULL,
+    0x00004204850400C0ULL, 0x0200100410A42102ULL, 0x1040020801210102ULL, 0x0805040410420000ULL,
+    0x2884804130100200ULL, 0x800C262201242000ULL, 0x1058000194108800ULL, 0x0014221054420204ULL,
+    0x0104000012A02200ULL, 0x0200881003300100ULL, 0x0140400202840100ULL, 0x0402020801010201ULL
+};
+
+// Leaper attacks and empty-board ray geometry depend on nothing but the
+// squares involved, so the compiler computes them: they sit in read-only
+// data instead of being built at startup.
+struct SquareTables {
+    Bitboard knight[64] = {};
+    Bitboard king[64] = {};
+    Bitboard pawn[2][64] = {}; // squares attacked by a pawn of the given color
+    Bitboard rays[8][64] = {}; // empty-board ray from a square, square excluded
+    Bitboard between[64][64] = {}; // squares strictly between two aligned squares
+    Bitboard line[64][64] = {};    // full line through two aligned squares
+
+    constexpr SquareTables() {
+        const int rayDr[8] = { 1, 0, 1, 1, -1,  0, -1, -1 };
+        const int rayDc[8] = { 0, 1, 1, -1, 0, -1, -1,  1 };
+        const int knightDr[8] = {-2,-2,-1,-1,1,1,2,2};
+        const int knightDc[8] = {-1,1,-2,2,-2,2,-1,1};
+
+        auto bitAt = [](int r, int c) -> Bitboard {
+            if (r < 0 || r >= 8 || c < 0 || c >= 8) return 0;
+            return squareBit(squareIndex(r, c));
+        };
+
+        for (int r = 0; r < 8; r++)
+            for (int c = 0; c < 8; c++) {
+                int sq = squareIndex(r, c);
+                knight[sq] = king[sq] = 0;
+                for (int i = 0; i < 8; i++)
+                    knight[sq] |= bitAt(r + knightDr[i], c + knightDc[i]);
+                for (int dr = -1; dr <= 1; dr++)
+                    for (int dc = -1; dc <= 1; dc++)
+                        if (dr != 0 || dc != 0) king[sq] |= bitAt(r + dr, c + dc);
+                pawn[WHITE][sq] = bitAt(r + 1, c - 1) | bitAt(r + 1, c + 1);
+                pawn[BLACK][sq] = bitAt(r - 1, c - 1) | bitAt(r - 1, c + 1);
+                for (int d = 0; d < 8; d++) {
+                    rays[d][sq] = 0;
+                    for (int step = 1; step < 8; step++)
+                        rays[d][sq] |= bitAt(r + rayDr[d]*step, c + rayDc[d]*step);
+                }
+            }
+
+        for (int sq = 0; sq < 64; sq++) {
+            for (int d = 0; d < 8; d++) {
+                int back = (d + 4) % 8; // opposite direction
+                for (Bitboard ray = rays[d][sq]; ray; ) {
+                    int t = popLsb(ray);
+                    between[sq][t] = rays[d][sq] & rays[back][t];
+                    line[sq][t] = rays[d][sq] | rays[back][sq] | squareBit(sq);
+                }
+            }
+        }
+    }
+};
+
+inline constexpr SquareTables TABLES;
+
+// Slider attack lookup. Which indexing scheme fills the tables depends on
+// the CPU, so these are built once at startup.
+struct AttackTables {
+    bool usePext;
+    SliderMagic rookMagics[64];
+    SliderMagic bishopMagics[64];
+    Bitboard rookTable[0x19000] = {};  // 102400 entries: sum of 2^bits over squares
+    Bitboard bishopTable[0x1480] = {}; // 5248 entries
+
+    AttackTables() {
+        usePext = cpuHasPext();
+        const Direction rookDirs[4]   = { NORTH, SOUTH, EAST, WEST };
+        const Direction bishopDirs[4] = { NORTH_EAST, NORTH_WEST, SOUTH_EAST, SOUTH_WEST };
+        initSliders(rookMagics, rookTable, ROOK_MAGICS, rookDirs);
+        initSliders(bishopMagics, bishopTable, BISHOP_MAGICS, bishopDirs);
+    }
+
+    // Ray walk used to fill the lookup tables; the hot path never calls it
+    Bitboard rayAttacks(int d, int sq, Bitboard occ) const {
+        Bitboard ray = TABLES.rays[d][sq];
+        Bitboard blockers = ray & occ;
+        if (blockers) {
+            int b = (d < SOUTH) ? lsb(blockers) : msb(blockers);
+            ray ^= TABLES.rays[d][b];
+        }
+        return ray;
+    }
+
+    Bitboard rookAttacks(int sq, Bitboard occ) const {
+        const SliderMagic& m = rookMagics[sq];
+        return m.attacks[m.index(occ, usePext)];
+    }
+
+    Bitboard bishopAttacks(int sq, Bitboard occ) const {
+        const SliderMagic& m = bishopMagics[sq];
+        return m.attacks[m.index(occ, usePext)];
+    }
+
+private:
+    void initSliders(SliderMagic magics[64], Bitboard* table,
+                     const Bitboard magicNumbers[64], const Direction dirs[4]) {
+        Bitboard* next = table;
+        for (int sq = 0; sq < 64; sq++) {
+            SliderMagic& m = magics[sq];
+            // Edge squares never change the attack set, so leave them out of
+            // the mask unless the slider itself stands on that edge.
+            const Bitboard rank1 = 0xFF, fileA = 0x0101010101010101ULL;
+            Bitboard edges = ((rank1 | rank1 << 56) & ~(rank1 << (8 * (sq / 8))))
+                           | ((fileA | fileA << 7) & ~(fileA << (sq % 8)));
+            m.mask = 0;
+            for (int i = 0; i < 4; i++) m.mask |= TABLES.rays[dirs[i]][sq];
+            m.mask &= ~edges;
+            m.magic = magicNumbers[sq];
+            m.shift = 64 - popCount(m.mask);
+            m.attacks = next;
+
+            bool ok = fillSquare(m, sq, dirs, next, usePext);
+            // With PEXT the magics are never used here, so check them in a
+            // scratch table: a bad edit must not wait for a CPU without BMI2
+            if (ok && usePext) {
+                static Bitboard scratch[4096];
+                std::fill(scratch, scratch + (size_t(1) << popCount(m.mask)), 0);
+                ok = fillSquare(m, sq, dirs, scratch, false);
+            }
+            if (!ok) {
+                std::fprintf(stderr, "%s magic for square %d maps two blocker sets with "
+                             "different attacks to one slot\n", (dirs[0] == NORTH) ? "Rook" : "Bishop", sq);
+                std::abort();
+            }
+            next += Bitboard(1) << popCount(m.mask);
+        }
+    }
+
+    // Store the attacks of every blocker subset of m.mask (Carry-Rippler
+    // enumeration) in slots, which must start zeroed. No slider attack set
+    // is empty, so a non-zero slot holding different attacks is a
+    // destructive collision; returns false if one is found.
+    bool fillSquare(const SliderMagic& m, int sq, const Direction dirs[4], Bitboard* slots,
+                    bool pext) const {
+        Bitboard subset = 0;
+        do {
+            Bitboard attacks = 0;
+            for (int i = 0; i < 4; i++)
+                attacks |= rayAttacks(dirs[i], sq, subset);
+            Bitboard& slot = slots[m.index(subset, pext)];
+            if (slot && slot != attacks) return false;
+            slot = attacks;
+            subset = (subset - m.mask) & m.mask;
+        } while (subset);
+        return true;
+    }
+};
+
+inline const AttackTables ATTACKS;
+
+// ============================================================================
+// Per-piece rules as templates — the piece is a template parameter, so each
+// instance is straight-line code for that one piece and color
+// ============================================================================
+
+// Squares attacked by a piece of type P standing on sq, given the occupancy
+template <Piece P>
+inline Bitboard attacksOf(int sq, Bitboard occ) {
+    if constexpr (P == W_PAWN) return TABLES.pawn[WHITE][sq];
+    else if constexpr (P == B_PAWN) return TABLES.pawn[BLACK][sq];
+    else if constexpr (P == W_KNIGHT || P == B_KNIGHT) return TABLES.knight[sq];
+    else if constexpr (P == W_BISHOP || P == B_BISHOP) return ATTACKS.bishopAttacks(sq, occ);
+    else if constexpr (P == W_ROOK || P == B_ROOK) return ATTACKS.rookAttacks(sq, occ);
+    else if constexpr (P == W_QUEEN || P == B_QUEEN)
+        return ATTACKS.rookAttacks(sq, occ) | ATTACKS.bishopAttacks(sq, occ);
+    else if constexpr (P == W_KING || P == B_KING) return TABLES.king[sq];
+    else return 0;
+}
+
+// Call f(std::integral_constant<Piece, p>()) for a piece only known at run
+// time, so f can hand it on as a template argument (decltype(arg)::value)
+template <class F>
+inline decltype(auto) visitPiece(Piece p, F&& f) {
+    switch (p) {
+    case W_PAWN:   return f(std::integral_constant<Piece, W_PAWN>());
+    case W_KNIGHT: return f(std::integral_constant<Piece, W_KNIGHT>());
+    case W_BISHOP: return f(std::integral_constant<Piece, W_BISHOP>());
+    case W_ROOK:   return f(std::integral_constant<Piece, W_ROOK>());
+    case W_KING:   return f(std::integral_constant<Piece, W_KING>());
+    case W_QUEEN:  return f(std::integral_constant<Piece, W_QUEEN>());
+    case B_PAWN:   return f(std::integral_constant<Piece, B_PAWN>());
+    case B_KNIGHT: return f(std::integral_constant<Piece, B_KNIGHT>());
+    case B_BISHOP: return f(std::integral_constant<Piece, B_BISHOP>());
+    case B_ROOK:   return f(std::integral_constant<Piece, B_ROOK>());
+    case B_KING:   return f(std::integral_constant<Piece, B_KING>());
+    case B_QUEEN:  return f(std::integral_constant<Piece, B_QUEEN>());
+    default:       return f(std::integral_constant<Piece, EMPTY>());
+    }
+}
+
+template <Piece First, class F, size_t... I>
+inline void forEachPieceTypeFrom(F& f, std::index_sequence<I...>) {
+    (f(std::integral_constant<Piece, static_cast<Piece>(First + I)>()), ...);
+}
+
+// Call f(std::integral_constant<Piece, P>()) for each of color C's six piece
+// types, or for all twelve
+template <Color C, class F>
+inline void forEachPieceTypeOf(F&& f) {
+    forEachPieceTypeFrom<(C == WHITE) ? W_PAWN : B_PAWN>(f, std::make_index_sequence<6>());
+}
+
+template <class F>
+inline void forEachPieceType(F&& f) {
+    forEachPieceTypeFrom<W_PAWN>(f, std::make_index_sequence<12>());
+}
+
+// Squares attacked by piece p standing on sq, given the board occupancy
+inline Bitboard pieceAttacks(Piece p, int sq, Bitboard occ) {
+    return visitPiece(p, [&](auto piece) { return attacksOf<decltype(piece)::value>(sq, occ); });
+}
+
+// ============================================================================
+// Zobrist keys — random 64-bit codes XORed together into a position key
+// ============================================================================
+
+struct ZobristKeys {
+    uint64_t piece[13][64]; // indexed by Piece and square (EMPTY unused)
+    uint64_t castling[16];  // indexed by CASTLE_* bit set
+    uint64_t enPassant[8];  // by file, only while a capture is possible
+    uint64_t blackToMove;
+
+    ZobristKeys() {
+        // splitmix64 with a fixed seed, so keys are stable across runs and
+        // can be stored on disk
+        uint64_t state = 0x2545F4914F6CDD1DULL;
+        auto next = [&state]() {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        };
+        for (auto& bySquare : piece)
+            for (auto& k : bySquare) k = next();
+        castling[0] = 0;
+        for (int i = 1; i < 16; i++) castling[i] = next();
+        for (auto& k : enPassant) k = next();
+        blackToMove = next();
+    }
+};
+
+inline const ZobristKeys ZOBRIST;
+
+// ============================================================================
+// Board Class — Game state and rules
+// ============================================================================
+
+// Keys of the positions a game went through, for threefold repetition.
+// Kept by whoever plays the game forward (GameTimeline, a replay loop)
+// rather than in Board, which stays small to copy: push the key of the
+// position being left before each makeMove, pop after each unmakeMove.
+class KeyHistory {
+public:
+    void push(uint64_t key) { keys.push_back(key); }
+    // A history rebuilt mid-game can be shorter than the moves taken back
+    void pop() {
+        if (!keys.empty()) keys.pop_back();
+    }
+    void clear() { keys.clear(); }
+    size_t size() const { return keys.size(); }
+
+    // How many times the position with this key occurred before. Only
+    // positions since the last capture or pawn move can match it, and of
+    // those only every second one has the same side to move, so this reads
+    // at most halfmoveClock / 2 keys.
+    int repetitions(uint64_t key, unsigned halfmoveClock) const {
+        size_t back = std::min<size_t>(halfmoveClock, keys.size());
+        int count = 0;
+        for (size_t n = 4; n <= back; n += 2)
+            if (keys[keys.size() - n] == key) count++;
+        return count;
+    }
+
+private:
+    std::vector<uint64_t> keys;
+};
+
+// What makeMove() overwrites and unmakeMove() cannot work out from the move
+struct UndoInfo {
+    Piece moved;       // piece that left the from-square (the pawn on promotion)
+    Piece captured;    // EMPTY if none; the taken pawn for en passant
+    int8_t enPassantCol;
+    uint8_t castling;  // castle rights as CASTLE_* bits
+    uint16_t halfmoveClock;
+    uint64_t key;      // Zobrist key before the move
+};
+
+enum CastleBits { CASTLE_WK = 1, CASTLE_WQ = 2, CASTLE_BK = 4, CASTLE_BQ = 8 };
+
+// Check and pin information for one side, computed once per position so
+// each candidate move is validated with a few mask tests.
+struct LegalContext {
+    int kingSq;          // -1 if the side has no king
+    Bitboard checkers;   // enemy pieces giving check
+    Bitboard checkMask;  // destinations that resolve a single check (all if none)
+    Bitboard pinned;     // own pieces pinned to the king
+};
+
+enum GameResult : uint8_t {
+    RESULT_NONE, RESULT_WHITE_MATES, RESULT_BLACK_MATES, RESULT_STALEMATE,
+    RESULT_REPETITION, RESULT_FIFTY_MOVES
+};
+
+inline const char* resultText(GameResult result) {
+    switch (result) {
+    case RESULT_WHITE_MATES: return "White wins by checkmate!";
+    case RESULT_BLACK_MATES: return "Black wins by checkmate!";
+    case RESULT_STALEMATE:   return "Stalemate — draw!";
+    case RESULT_REPETITION:  return "Threefold repetition — draw!";
+    case RESULT_FIFTY_MOVES: return "Fifty-move rule — draw!";
+    default:                 return "";
+    }
+}
+
+// Compact, trivially copyable snapshot of a position for storing in bulk:
+// 40 bytes, so several fit in a cache line and millions in a few tens of MB.
+struct PackedPosition {
+    uint8_t squares[32]; // two squares per byte, the lower index in the low nibble
+    uint64_t state;      // bit 0 side to move, bits 1-4 castle rights (CASTLE_*),
+                         // bits 5-8 en passant file + 1 (0 = none),
+                         // bits 9-24 halfmove clock; rest zero
+};
+static_assert(sizeof(PackedPosition) == 40, "PackedPosition must stay 40 bytes");
+
+class Board {
+public:
+    // Array view of the position, kept in sync with the bitboards below.
+    // Read it freely; change the position only through Board methods.
+    std::array<std::array<Piece, 8>, 8> squares;
+    std::array<Bitboard, 13> pieces; // one set per Piece value (EMPTY unused)
+    std::array<Bitboard, 2> colors;  // indexed by Color
+    Bitboard occupied;
+    uint64_t key;     // Zobrist key, kept up to date by every Board mutation
+    // Pieces of each color attacking each square, maintained incrementally by
+    // makeMove/unmakeMove. Code that calls setPiece directly must finish with
+    // recomputeAttackCounts().
+    std::array<std::array<uint8_t, 64>, 2> attackCount;
+    Color sideToMove;
+    uint8_t castleRights; // CASTLE_* bits
+    int8_t enPassantCol; // -1 if none, or if no pawn can take en passant
+    uint16_t halfmoveClock; // plies since the last capture or pawn move
+    bool gameOver;
+    GameResult result;   // why the game is over; see resultText()
+
+    Board() { reset(); }
+
+    void clear() {
+        for (auto& row : squares)
+            row.fill(EMPTY);
+        pieces.fill(0);
+        colors.fill(0);
+        occupied = 0;
+        key = 0;
+        for (auto& counts : attackCount) counts.fill(0);
+        halfmoveClock = 0;
+    }
+
+    void setPiece(int r, int c, Piece p) {
+        removePiece(r, c);
+        if (p == EMPTY) return;
+        Bitboard bit = squareBit(squareIndex(r, c));
+        squares[r][c] = p;
+        pieces[p] |= bit;
+        colors[pieceColor(p)] |= bit;
+        occupied |= bit;
+        key ^= ZOBRIST.piece[p][squareIndex(r, c)];
+    }
+
+    void removePiece(int r, int c) {
+        Piece p = squares[r][c];
+        if (p == EMPTY) return;
+        Bitboard bit = squareBit(squareIndex(r, c));
+        squares[r][c] = EMPTY;
+        pieces[p] &= ~bit;
+        colors[pieceColor(p)] &= ~bit;
+        occupied &= ~bit;
+        key ^= ZOBRIST.piece[p][squareIndex(r, c)];
+    }
+
+    void reset() {
+        clear();
+
+        const Piece whiteRank[8] = { W_ROOK, W_KNIGHT, W_BISHOP, W_QUEEN,
+                                     W_KING, W_BISHOP, W_KNIGHT, W_ROOK };
+        const Piece blackRank[8] = { B_ROOK, B_KNIGHT, B_BISHOP, B_QUEEN,
+                                     B_KING, B_BISHOP, B_KNIGHT, B_ROOK };
+        for (int c = 0; c < 8; c++) {
+            setPiece(0, c, whiteRank[c]);
+            setPiece(1, c, W_PAWN);
+            setPiece(6, c, B_PAWN);
+            setPiece(7, c, blackRank[c]);
+        }
+
+        sideToMove = WHITE;
+        castleRights = CASTLE_WK | CASTLE_WQ | CASTLE_BK | CASTLE_BQ;
+        enPassantCol = -1;
+        key = computeKey();
+        recomputeAttackCounts();
+        gameOver = false;
+        result = RESULT_NONE;
+    }
+
+    // Key of the current position built from scratch; makeMove keeps
+    // Board::key equal to this incrementally.
+    uint64_t computeKey() const {
+        uint64_t k = 0;
+        for (Bitboard b = occupied; b; ) {
+            int sq = popLsb(b);
+            k ^= ZOBRIST.piece[squares[sq / 8][sq % 8]][sq];
+        }
+        k ^= ZOBRIST.castling[castleRights];
+        if (enPassantCol >= 0) k ^= ZOBRIST.enPassant[enPassantCol];
+        if (sideToMove == BLACK) k ^= ZOBRIST.blackToMove;
+        return k;
+    }
+
+    // Whether a pawn of the side to move stands beside a pawn that just
+    // advanced two squares on file col. The en passant file is only recorded
+    // when this holds, so positions that differ in nothing else share a key.
+    bool canCaptureEnPassant(int col) const {
+        int row = (sideToMove == WHITE) ? 4 : 3;
+        Piece pawn = (sideToMove == WHITE) ? W_PAWN : B_PAWN;
+        return (col > 0 && squares[row][col - 1] == pawn)
+            || (col < 7 && squares[row][col + 1] == pawn);
+    }
+
+    // Set up the position described by a FEN string. The move counters are
+    // optional; the halfmove clock is read and the fullmove number ignored.
+    // Returns false if the placement, side to move, castling or en passant
+    // fields are malformed, or if the placement is one the rules can't
+    // handle: each side needs exactly one king, and no pawn may stand on
+    // the first or last rank.
+    bool loadFEN(const std::string& fen) {
+        std::istringstream in(fen);
+        std::string placement, side, castling = "-", enPassant = "-";
+        unsigned clock = 0;
+        if (!(in >> placement >> side)) return false;
+        in >> castling >> enPassant >> clock;
+
+        clear();
+        const std::string pieceChars = "PNBRKQpnbrkq";
+        int r = 7, c = 0;
+        for (char ch : placement) {
+            if (ch == '/') {
+                if (c != 8 || r == 0) return false;
+                r--;
+                c = 0;
+            } else if (ch >= '1' && ch <= '8') {
+                c += ch - '0';
+                if (c > 8) return false;
+            } else {
+                auto idx = pieceChars.find(ch);
+                if (idx == std::string::npos || c >= 8) return false;
+                setPiece(r, c++, static_cast<Piece>(idx + 1));
+            }
+        }
+        if (r != 0 || c != 8) return false;
+        const Bitboard backRanks = 0xFF000000000000FFULL;
+        if (popCount(pieces[W_KING]) != 1 || popCount(pieces[B_KING]) != 1
+            || ((pieces[W_PAWN] | pieces[B_PAWN]) & backRanks))
+            return false;
+
+        if (side != "w" && side != "b") return false;
+        sideToMove = (side == "w") ? WHITE : BLACK;
+
+        castleRights = 0;
+        if (castling != "-") {
+            for (char ch : castling) {
+                if (ch == 'K') castleRights |= CASTLE_WK;
+                else if (ch == 'Q') castleRights |= CASTLE_WQ;
+                else if (ch == 'k') castleRights |= CASTLE_BK;
+                else if (ch == 'q') castleRights |= CASTLE_BQ;
+                else return false;
+            }
+        }
+
+        enPassantCol = -1;
+        if (enPassant != "-") {
+            if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h'
+                || (enPassant[1] != '3' && enPassant[1] != '6'))
+                return false;
+            if (canCaptureEnPassant(enPassant[0] - 'a'))
+                enPassantCol = static_cast<int8_t>(enPassant[0] - 'a');
+        }
+        halfmoveClock = static_cast<uint16_t>(std::min(clock, 0xFFFFu));
+
+        key = computeKey();
+        recomputeAttackCounts();
+        updateGameOver();
+        return true;
+    }
+
+    // Set up the position of an EPD record: the four FEN position fields
+    // followed by optional operations ("bm e4; id \"x\";"). The operations
+    // text is returned through ops when given.
+    bool loadEPD(const std::string& epd, std::string* ops = nullptr) {
+        std::istringstream in(epd);
+        std::string placement, side, castling, enPassant;
+        if (!(in >> placement >> side >> castling >> enPassant)) return false;
+        if (!loadFEN(placement + " " + side + " " + castling + " " + enPassant))
+            return false;
+        if (ops) {
+            std::string rest;
+            std::getline(in, rest);
+            size_t first = rest.find_first_not_of(" \t");
+            size_t last = rest.find_last_not_of(" \t\r\n");
+            *ops = (first == std::string::npos) ? "" : rest.substr(first, last - first + 1);
+        }
+        return true;
+    }
+
+    // The four position fields shared by FEN and EPD. The en passant square
+    // is only written when a capture there is possible.
+    std::string toEPD() const {
+        const char pieceChars[] = ".PNBRKQpnbrkq";
+        std::string out;
+        for (int r = 7; r >= 0; r--) {
+            int empty = 0;
+            for (int c = 0; c < 8; c++) {
+                Piece p = squares[r][c];
+                if (p == EMPTY) {
+                    empty++;
+                    continue;
+                }
+                if (empty) out += static_cast<char>('0' + empty);
+                empty = 0;
+                out += pieceChars[p];
+            }
+            if (empty) out += static_cast<char>('0' + empty);
+            if (r > 0) out += '/';
+        }
+
+        out += (sideToMove == WHITE) ? " w " : " b ";
+        if (castleRights & CASTLE_WK) out += 'K';
+        if (castleRights & CASTLE_WQ) out += 'Q';
+        if (castleRights & CASTLE_BK) out += 'k';
+        if (castleRights & CASTLE_BQ) out += 'q';
+        if (!castleRights) out += '-';
+
+        out += ' ';
+        if (enPassantCol >= 0) out += squareName(sideToMove == WHITE ? 5 : 2, enPassantCol);
+        else out += '-';
+        return out;
+    }
+
+    // The fullmove number is not tracked, so it is written as 1
+    std::string toFEN() const {
+        return toEPD() + " " + std::to_string(halfmoveClock) + " 1";
+    }
+
+    PackedPosition pack() const {
+        PackedPosition packed;
+        for (int sq = 0; sq < 64; sq += 2)
+            packed.squares[sq / 2] = static_cast<uint8_t>(
+                squares[sq / 8][sq % 8] | (squares[sq / 8][sq % 8 + 1] << 4));
+        packed.state = static_cast<uint64_t>(sideToMove)
+                     | static_cast<uint64_t>(castleRights) << 1
+                     | static_cast<uint64_t>(enPassantCol + 1) << 5
+                     | static_cast<uint64_t>(halfmoveClock) << 9;
+        return packed;
+    }
+
+    // Restore a packed position, rebuilding the bitboards, key and attack
+    // counts. gameOver is left clear; call updateGameOver() when it matters.
+    void unpack(const PackedPosition& packed) {
+        clear();
+        for (int sq = 0; sq < 64; sq++) {
+            Piece p = static_cast<Piece>((packed.squares[sq / 2] >> (4 * (sq & 1))) & 0xF);
+            if (p != EMPTY) setPiece(sq / 8, sq % 8, p);
+        }
+        sideToMove = static_cast<Color>(packed.state & 1);
+        castleRights = static_cast<uint8_t>((packed.state >> 1) & 0xF);
+        enPassantCol = static_cast<int8_t>(static_cast<int>((packed.state >> 5) & 0xF) - 1);
+        halfmoveClock = static_cast<uint16_t>(packed.state >> 9);
+        key = computeKey();
+        recomputeAttackCounts();
+        gameOver = false;
+        result = RESULT_NONE;
+    }
+
+    bool inBounds(int r, int c) const {
+        return r >= 0 && r < 8 && c >= 0 && c < 8;
+    }
+
+    Piece pieceOn(int sq) const { return squares[sq / 8][sq % 8]; }
+
+    std::pair<int,int> findKing(Color col) const {
+        Bitboard king = pieces[(col == WHITE) ? W_KING : B_KING];
+        if (!king) return {-1, -1};
+        int sq = lsb(king);
+        return {sq / 8, sq % 8};
+    }
+
+    // All pieces of color attacker that attack sq under occupancy occ
+    Bitboard attackersTo(int sq, Color attacker, Bitboard occ) const {
+        bool w = (attacker == WHITE);
+        Bitboard rookLike   = pieces[w ? W_ROOK : B_ROOK]     | pieces[w ? W_QUEEN : B_QUEEN];
+        Bitboard bishopLike = pieces[w ? W_BISHOP : B_BISHOP] | pieces[w ? W_QUEEN : B_QUEEN];
+        // A pawn of the attacking color hits sq from the squares a pawn of
+        // the other color on sq would attack.
+        return (TABLES.pawn[w ? BLACK : WHITE][sq] & pieces[w ? W_PAWN : B_PAWN])
+             | (TABLES.knight[sq] & pieces[w ? W_KNIGHT : B_KNIGHT])
+             | (TABLES.king[sq]   & pieces[w ? W_KING : B_KING])
+             | (ATTACKS.rookAttacks(sq, occ)   & rookLike)
+             | (ATTACKS.bishopAttacks(sq, occ) & bishopLike);
+    }
+
+    bool isSquareAttackedBy(int r, int c, Color attacker) const {
+        return attackersTo(squareIndex(r, c), attacker, occupied) != 0;
+    }
+
+    bool isInCheck(Color col) const {
+        auto [kr, kc] = findKing(col);
+        Color enemy = (col == WHITE) ? BLACK : WHITE;
+        return isSquareAttackedBy(kr, kc, enemy);
+    }
+
+    // Pseudo-legal moves of the piece on (r, c), appended to moves
+    void generatePieceMoves(int r, int c, MoveList& moves) const {
+        Bitboard from = squareBit(squareIndex(r, c));
+        visitPiece(squares[r][c], [&](auto piece) {
+            generateMoves<decltype(piece)::value>(from, moves);
+        });
+    }
+
+    // Pseudo-legal moves of the pieces of type P standing on the squares in
+    // from. Castling is generated with the king.
+    template <Piece P>
+    void generateMoves(Bitboard from, MoveList& moves) const {
+        constexpr Color us = pieceColor(P);
+        if constexpr (P == W_PAWN || P == B_PAWN) {
+            generatePawnMoves<us>(from, moves);
+        } else if constexpr (P != EMPTY) {
+            while (from) {
+                int sq = popLsb(from);
+                addMoves(sq, attacksOf<P>(sq, occupied) & ~colors[us], moves);
+            }
+            if constexpr (P == W_KING || P == B_KING) generateCastling<us>(moves);
+        }
+    }
+
+    // Every pseudo-legal move of color C, one piece type at a time
+    template <Color C>
+    void generateAllMoves(MoveList& moves) const {
+        forEachPieceTypeOf<C>([&](auto piece) {
+            constexpr Piece P = decltype(piece)::value;
+            generateMoves<P>(pieces[P], moves);
+        });
+    }
+
+    static void addMoves(int from, Bitboard targets, MoveList& moves) {
+        while (targets) moves.push_back(Move(from, popLsb(targets)));
+    }
+
+    static void addPromotions(int from, int to, MoveList& moves) {
+        moves.push_back(Move(from, to, W_QUEEN));
+        moves.push_back(Move(from, to, W_ROOK));
+        moves.push_back(Move(from, to, W_BISHOP));
+        moves.push_back(Move(from, to, W_KNIGHT));
+    }
+
+    // Pushes are generated for all pawns at once by shifting the set. A pawn
+    // reaching the last rank gives one move per promotion piece, queen first.
+    template <Color C>
+    void generatePawnMoves(Bitboard pawns, MoveList& moves) const {
+        constexpr Color them = (C == WHITE) ? BLACK : WHITE;
+        constexpr int forward = (C == WHITE) ? 8 : -8;
+        constexpr Bitboard thirdRank = Bitboard(0xFF) << ((C == WHITE) ? 16 : 40);
+        constexpr Bitboard lastRank = Bitboard(0xFF) << ((C == WHITE) ? 56 : 0);
+        auto advance = [](Bitboard b) { return (C == WHITE) ? b << 8 : b >> 8; };
+
+        Bitboard empty = ~occupied;
+        Bitboard single = advance(pawns) & empty;
+        for (Bitboard b = single & ~lastRank; b; ) {
+            int to = popLsb(b);
+            moves.push_back(Move(to - forward, to));
+        }
+        for (Bitboard b = single & lastRank; b; ) {
+            int to = popLsb(b);
+            addPromotions(to - forward, to, moves);
+        }
+        for (Bitboard b = advance(single & thirdRank) & empty; b; ) {
+            int to = popLsb(b);
+            moves.push_back(Move(to - 2 * forward, to));
+        }
+
+        Bitboard targets = colors[them];
+        if (enPassantCol >= 0)
+            targets |= squareBit(squareIndex((C == WHITE) ? 5 : 2, enPassantCol)) & empty;
+        while (pawns) {
+            int sq = popLsb(pawns);
+            Bitboard captures = TABLES.pawn[C][sq] & targets;
+            addMoves(sq, captures & ~lastRank, moves);
+            for (Bitboard b = captures & lastRank; b; ) addPromotions(sq, popLsb(b), moves);
+        }
+    }
+
+    template <Color C>
+    void generateCastling(MoveList& moves) const {
+        constexpr int row = (C == WHITE) ? 0 : 7;
+        constexpr Color them = (C == WHITE) ? BLACK : WHITE;
+        constexpr Piece king = (C == WHITE) ? W_KING : B_KING;
+        constexpr Piece rook = (C == WHITE) ? W_ROOK : B_ROOK;
+        bool kingSide = castleRights & ((C == WHITE) ? CASTLE_WK : CASTLE_BK);
+        bool queenSide = castleRights & ((C == WHITE) ? CASTLE_WQ : CASTLE_BQ);
+        if (!(kingSide || queenSide) || squares[row][4] != king || isSquareAttackedBy(row, 4, them))
+            return;
+        if (kingSide && squares[row][5] == EMPTY && squares[row][6] == EMPTY
+            && squares[row][7] == rook
+            && !isSquareAttackedBy(row, 5, them)
+            && !isSquareAttackedBy(row, 6, them))
+            moves.push_back(Move(squareIndex(row, 4), squareIndex(row, 6)));
+        if (queenSide && squares[row][3] == EMPTY && squares[row][2] == EMPTY
+            && squares[row][1] == EMPTY && squares[row][0] == rook
+            && !isSquareAttackedBy(row, 3, them)
+            && !isSquareAttackedBy(row, 2, them))
+            moves.push_back(Move(squareIndex(row, 4), squareIndex(row, 2)));
+    }
+
+    LegalContext legalContext(Color col) const {
+        LegalContext ctx{-1, 0, ~Bitboard(0), 0};
+        Bitboard king = pieces[(col == WHITE) ? W_KING : B_KING];
+        if (!king) return ctx;
+        ctx.kingSq = lsb(king);
+
+        Color enemy = (col == WHITE) ? BLACK : WHITE;
+        ctx.checkers = attackersTo(ctx.kingSq, enemy, occupied);
+        if (ctx.checkers)
+            ctx.checkMask = (popCount(ctx.checkers) == 1)
+                ? ctx.checkers | TABLES.between[ctx.kingSq][lsb(ctx.checkers)]
+                : 0;
+
+        // Enemy sliders lined up with the king through exactly one own piece
+        bool w = (enemy == WHITE);
+        Bitboard queens = pieces[w ? W_QUEEN : B_QUEEN];
+        Bitboard snipers =
+            (ATTACKS.rookAttacks(ctx.kingSq, 0)   & (pieces[w ? W_ROOK : B_ROOK] | queens))
+          | (ATTACKS.bishopAttacks(ctx.kingSq, 0) & (pieces[w ? W_BISHOP : B_BISHOP] | queens));
+        while (snipers) {
+            Bitboard blockers = TABLES.between[ctx.kingSq][popLsb(snipers)] & occupied;
+            if (popCount(blockers) == 1 && (blockers & colors[col]))
+                ctx.pinned |= blockers;
+        }
+        return ctx;
+    }
+
+    // Whether a pseudo-legal move from generatePieceMoves leaves the mover's
+    // king safe, decided from the context instead of playing the move.
+    bool isLegal(Move m, const LegalContext& ctx) const {
+        int from = m.from(), to = m.to();
+        Bitboard toBit = squareBit(to);
+        Piece p = pieceOn(from);
+        Color enemy = (pieceColor(p) == WHITE) ? BLACK : WHITE;
+
+        if (from == ctx.kingSq) {
+            // Castling squares were already checked during generation
+            if (std::abs(m.toCol() - m.fromCol()) == 2) return true;
+            return !attackersTo(to, enemy, occupied ^ squareBit(from));
+        }
+        if (popCount(ctx.checkers) > 1) return false;
+
+        // En passant removes two pieces from a line, so test it directly
+        if ((p == W_PAWN || p == B_PAWN) && m.fromCol() != m.toCol() && pieceOn(to) == EMPTY) {
+            Bitboard captured = squareBit(squareIndex(m.fromRow(), m.toCol()));
+            Bitboard occ = (occupied ^ squareBit(from) ^ captured) | toBit;
+            return !(attackersTo(ctx.kingSq, enemy, occ) & ~captured);
+        }
+
+        if (!(ctx.checkMask & toBit)) return false;
+        if ((ctx.pinned & squareBit(from)) && !(TABLES.line[ctx.kingSq][from] & toBit))
+            return false;
+        return true;
+    }
+
+    // Drop the moves that would leave the king in check
+    void keepLegal(MoveList& moves, const LegalContext& ctx) const {
+        Move* last = std::remove_if(moves.begin(), moves.end(),
+                                    [&](Move m) { return !isLegal(m, ctx); });
+        moves.resize(static_cast<size_t>(last - moves.begin()));
+    }
+
+    // Legal moves of the piece on (r, c), replacing the list's contents
+    void getLegalMoves(int r, int c, MoveList& moves) const {
+        PROFILE_SCOPE("Board::getLegalMoves");
+        moves.clear();
+        generatePieceMoves(r, c, moves);
+        keepLegal(moves, legalContext(pieceColor(squares[r][c])));
+    }
+
+    // Legal moves of the side to move, replacing the list's contents
+    void getAllLegalMoves(MoveList& moves) const {
+        PROFILE_SCOPE("Board::getAllLegalMoves");
+        moves.clear();
+        LegalContext ctx = legalContext(sideToMove);
+        // In double check only the king can move
+        bool white = (sideToMove == WHITE);
+        if (popCount(ctx.checkers) > 1) {
+            if (white) generateMoves<W_KING>(pieces[W_KING], moves);
+            else generateMoves<B_KING>(pieces[B_KING], moves);
+        } else {
+            if (white) generateAllMoves<WHITE>(moves);
+            else generateAllMoves<BLACK>(moves);
+        }
+        keepLegal(moves, ctx);
+    }
+
+    void applyMoveRaw(Move m) {
+        int fromRow = m.fromRow(), fromCol = m.fromCol();
+        int toRow = m.toRow(), toCol = m.toCol();
+        Piece p = squares[fromRow][fromCol];
+
+        // En passant capture
+        if ((p == W_PAWN || p == B_PAWN) && fromCol != toCol && squares[toRow][toCol] == EMPTY)
+            removePiece(fromRow, toCol);
+
+        // Castling — move the rook
+        if ((p == W_KING || p == B_KING) && std::abs(toCol - fromCol) == 2) {
+            if (toCol == 6) {
+                setPiece(fromRow, 5, squares[fromRow][7]);
+                removePiece(fromRow, 7);
+            } else {
+                setPiece(fromRow, 3, squares[fromRow][0]);
+                removePiece(fromRow, 0);
+            }
+        }
+
+        removePiece(fromRow, fromCol);
+        setPiece(toRow, toCol, p);
+
+        // Promotion to the move's piece; a move built without one queens
+        if ((p == W_PAWN && toRow == 7) || (p == B_PAWN && toRow == 0)) {
+            Piece promoted = (m.promotion() != EMPTY) ? m.promotion() : W_QUEEN;
+            if (p == B_PAWN) promoted = static_cast<Piece>(promoted + (B_PAWN - W_PAWN));
+            setPiece(toRow, toCol, promoted);
+        }
+    }
+
+    // Play a move in place, recording what unmakeMove() needs to take it
+    // back. Unlike makeMove(m) this does not look for the end of the game.
+    void makeMove(Move m, UndoInfo& undo) {
+        int fromRow = m.fromRow(), fromCol = m.fromCol();
+        int toRow = m.toRow(), toCol = m.toCol();
+        Piece p = squares[fromRow][fromCol];
+        bool enPassant = (p == W_PAWN || p == B_PAWN) && fromCol != toCol
+                         && squares[toRow][toCol] == EMPTY;
+        undo.moved = p;
+        undo.captured = enPassant ? squares[fromRow][toCol] : squares[toRow][toCol];
+        undo.enPassantCol = enPassantCol;
+        undo.castling = castleRights;
+        undo.halfmoveClock = halfmoveClock;
+        undo.key = key;
+        bool irreversible = (p == W_PAWN || p == B_PAWN) || undo.captured != EMPTY;
+        halfmoveClock = irreversible ? 0 : halfmoveClock + 1;
+
+        key ^= ZOBRIST.castling[undo.castling];
+        if (enPassantCol >= 0) key ^= ZOBRIST.enPassant[enPassantCol];
+
+        Bitboard changed = moveFootprint(m, p, enPassant);
+        Bitboard affected = beginAttackUpdate(changed);
+        applyMoveRaw(m);
+        endAttackUpdate(affected, changed);
+
+        sideToMove = (sideToMove == WHITE) ? BLACK : WHITE;
+        key ^= ZOBRIST.blackToMove;
+
+        // Update en passant
+        enPassantCol = -1;
+        if ((p == W_PAWN || p == B_PAWN) && std::abs(toRow - fromRow) == 2
+            && canCaptureEnPassant(fromCol)) {
+            enPassantCol = static_cast<int8_t>(fromCol);
+            key ^= ZOBRIST.enPassant[enPassantCol];
+        }
+
+        // Update castling rights
+        if (p == W_KING)   castleRights &= ~(CASTLE_WK | CASTLE_WQ);
+        if (p == B_KING)   castleRights &= ~(CASTLE_BK | CASTLE_BQ);
+        if (p == W_ROOK && fromRow == 0 && fromCol == 0) castleRights &= ~CASTLE_WQ;
+        if (p == W_ROOK && fromRow == 0 && fromCol == 7) castleRights &= ~CASTLE_WK;
+        if (p == B_ROOK && fromRow == 7 && fromCol == 0) castleRights &= ~CASTLE_BQ;
+        if (p == B_ROOK && fromRow == 7 && fromCol == 7) castleRights &= ~CASTLE_BK;
+
+        // If a rook is captured on its starting square
+        if (toRow == 0 && toCol == 0) castleRights &= ~CASTLE_WQ;
+        if (toRow == 0 && toCol == 7) castleRights &= ~CASTLE_WK;
+        if (toRow == 7 && toCol == 0) castleRights &= ~CASTLE_BQ;
+        if (toRow == 7 && toCol == 7) castleRights &= ~CASTLE_BK;
+
+        key ^= ZOBRIST.castling[castleRights];
+
+#ifdef CHESS_DEBUG_ATTACKS
+        assert(attackCountsMatchFullScan());
+#endif
+    }
+
+    void unmakeMove(Move m, const UndoInfo& undo) {
+        int fromRow = m.fromRow(), fromCol = m.fromCol();
+        int toRow = m.toRow(), toCol = m.toCol();
+        sideToMove = (sideToMove == WHITE) ? BLACK : WHITE;
+        enPassantCol = undo.enPassantCol;
+        castleRights = undo.castling;
+        halfmoveClock = undo.halfmoveClock;
+
+        // The en passant target square is always empty, so a pawn capture
+        // landing on it took the pawn beside it
+        Piece p = undo.moved;
+        int epRow = (p == W_PAWN) ? 5 : 2;
+        bool enPassant = (p == W_PAWN || p == B_PAWN) && fromCol != toCol
+                         && toCol == enPassantCol && toRow == epRow;
+        Bitboard changed = moveFootprint(m, p, enPassant);
+        Bitboard affected = beginAttackUpdate(changed);
+
+        // Removing whatever stands on the to-square also takes back a
+        // promotion, since the pawn is restored from undo.moved
+        removePiece(toRow, toCol);
+        setPiece(fromRow, fromCol, undo.moved);
+
+        if (enPassant)
+            setPiece(fromRow, toCol, undo.captured);
+        else if (undo.captured != EMPTY)
+            setPiece(toRow, toCol, undo.captured);
+
+        // Castling — put the rook back
+        if ((p == W_KING || p == B_KING) && std::abs(toCol - fromCol) == 2) {
+            if (toCol == 6) {
+                setPiece(fromRow, 7, squares[fromRow][5]);
+                removePiece(fromRow, 5);
+            } else {
+                setPiece(fromRow, 0, squares[fromRow][3]);
+                removePiece(fromRow, 3);
+            }
+        }
+        endAttackUpdate(affected, changed);
+        key = undo.key;
+
+#ifdef CHESS_DEBUG_ATTACKS
+        assert(attackCountsMatchFullScan());
+#endif
+    }
+
+    // Squares whose occupancy a move changes: from and to, plus the pawn
+    // taken en passant or the rook that castles
+    Bitboard moveFootprint(Move m, Piece p, bool enPassant) const {
+        Bitboard changed = squareBit(m.from()) | squareBit(m.to());
+        if (enPassant)
+            changed |= squareBit(squareIndex(m.fromRow(), m.toCol()));
+        if ((p == W_KING || p == B_KING) && std::abs(m.toCol() - m.fromCol()) == 2) {
+            bool kingSide = (m.toCol() == 6);
+            changed |= squareBit(squareIndex(m.fromRow(), kingSide ? 7 : 0))
+                     | squareBit(squareIndex(m.fromRow(), kingSide ? 5 : 3));
+        }
+        return changed;
+    }
+
+    void addPieceAttacks(int sq, int delta) {
+        Piece p = squares[sq / 8][sq % 8];
+        auto& counts = attackCount[pieceColor(p)];
+        for (Bitboard targets = pieceAttacks(p, sq, occupied); targets; )
+            counts[popLsb(targets)] += delta;
+    }
+
+    // Only pieces standing on a changed square, or sliders whose rays reach
+    // one, can gain or lose attacks. Their current attacks are subtracted
+    // before the board changes and added back afterwards by endAttackUpdate.
+    // A slider not reaching any changed square now cannot reach one after
+    // the change either, since the squares in front of it are untouched.
+    Bitboard beginAttackUpdate(Bitboard changed) {
+        Bitboard queens = pieces[W_QUEEN] | pieces[B_QUEEN];
+        Bitboard rookLike = pieces[W_ROOK] | pieces[B_ROOK] | queens;
+        Bitboard bishopLike = pieces[W_BISHOP] | pieces[B_BISHOP] | queens;
+
+        Bitboard affected = occupied & changed;
+        for (Bitboard b = changed; b; ) {
+            int sq = popLsb(b);
+            affected |= (ATTACKS.rookAttacks(sq, occupied) & rookLike)
+                      | (ATTACKS.bishopAttacks(sq, occupied) & bishopLike);
+        }
+        for (Bitboard b = affected; b; )
+            addPieceAttacks(popLsb(b), -1);
+        return affected;
+    }
+
+    void endAttackUpdate(Bitboard affected, Bitboard changed) {
+        affected = (affected & ~changed) | (occupied & changed);
+        for (Bitboard b = affected; b; )
+            addPieceAttacks(popLsb(b), +1);
+    }
+
+    void recomputeAttackCounts() {
+        for (auto& counts : attackCount) counts.fill(0);
+        forEachPieceType([&](auto piece) {
+            constexpr Piece P = decltype(piece)::value;
+            auto& counts = attackCount[pieceColor(P)];
+            for (Bitboard from = pieces[P]; from; )
+                for (Bitboard targets = attacksOf<P>(popLsb(from), occupied); targets; )
+                    counts[popLsb(targets)]++;
+        });
+    }
+
+    // Debug check of the incremental counts against a full recomputation
+    bool attackCountsMatchFullScan() const {
+        std::array<std::array<int,8>,8> white, black;
+        computeAttackCounts(white, black);
+        for (int sq = 0; sq < 64; sq++)
+            if (white[sq / 8][sq % 8] != attackCount[WHITE][sq]
+                || black[sq / 8][sq % 8] != attackCount[BLACK][sq])
+                return false;
+        return true;
+    }
+
+    // Play a move and detect mate, stalemate and the fifty-move rule for the
+    // side now to move. Threefold repetition is never detected here: Board
+    // keeps no history, so a caller that needs it pushes key into its own
+    // KeyHistory, plays with makeMove(m, undo) and calls
+    // updateGameOver(&history), as GameTimeline does.
+    void makeMove(Move m) {
+        UndoInfo undo;
+        makeMove(m, undo);
+        updateGameOver();
+    }
+
+    // Whether the side to move has any legal move, stopping at the first one
+    // found. King steps go first: they are the only moves in double check
+    // and the usual way out of a single one. Castling needs no test, since
+    // whenever it is legal the king's step towards the rook is too.
+    bool hasAnyLegalMove() const {
+        LegalContext ctx = legalContext(sideToMove);
+        return (sideToMove == WHITE) ? hasLegalMove<WHITE>(ctx) : hasLegalMove<BLACK>(ctx);
+    }
+
+    template <Color C>
+    bool hasLegalMove(const LegalContext& ctx) const {
+        constexpr Color them = (C == WHITE) ? BLACK : WHITE;
+        constexpr Piece king = (C == WHITE) ? W_KING : B_KING;
+        if (ctx.kingSq >= 0) {
+            Bitboard occ = occupied ^ squareBit(ctx.kingSq);
+            for (Bitboard to = TABLES.king[ctx.kingSq] & ~colors[C]; to; )
+                if (!attackersTo(popLsb(to), them, occ)) return true;
+        }
+        if (popCount(ctx.checkers) > 1) return false;
+
+        // Then one piece type at a time, stopping after the first with a legal move
+        bool found = false;
+        forEachPieceTypeOf<C>([&](auto piece) {
+            constexpr Piece P = decltype(piece)::value;
+            if constexpr (P != king) {
+                if (found || !pieces[P]) return;
+                MoveList moves;
+                generateMoves<P>(pieces[P], moves);
+                for (Move m : moves) {
+                    if (isLegal(m, ctx)) {
+                        found = true;
+                        return;
+                    }
+                }
+            }
+        });
+        return found;
+    }
+
+    // Recompute gameOver/resultText for the current position, so it also
+    // clears them when stepping back out of a finished game. Mate and
+    // stalemate take precedence over the draws by rule. Threefold repetition
+    // is only detected given the history of the game that led here.
+    void updateGameOver(const KeyHistory* history = nullptr) {
+        gameOver = true;
+        if (!hasAnyLegalMove())
+            result = !isInCheck(sideToMove) ? RESULT_STALEMATE
+                   : (sideToMove == WHITE)  ? RESULT_BLACK_MATES : RESULT_WHITE_MATES;
+        else if (halfmoveClock >= 100)
+            result = RESULT_FIFTY_MOVES;
+        else if (history && history->repetitions(key, halfmoveClock) >= 2)
+            result = RESULT_REPETITION;
+        else {
+            gameOver = false;
+            result = RESULT_NONE;
+        }
+    }
+
+    const char* resultText() const { return ::resultText(result); }
+
+    // Count how many white/black pieces attack each square (pseudo-legal)
+    void getAttackCounts(std::array<std::array<int,8>,8>& white,
+                         std::array<std::array<int,8>,8>& black) const {
+        PROFILE_SCOPE("Board::getAttackCounts");
+        for (int sq = 0; sq < 64; sq++) {
+            white[sq / 8][sq % 8] = attackCount[WHITE][sq];
+            black[sq / 8][sq % 8] = attackCount[BLACK][sq];
+        }
+    }
+
+    // Same counts as getAttackCounts, rebuilt from every piece's attacks
+    void computeAttackCounts(std::array<std::array<int,8>,8>& white,
+                             std::array<std::array<int,8>,8>& black) const {
+        for (auto& row : white) row.fill(0);
+        for (auto& row : black) row.fill(0);
+
+        forEachPieceType([&](auto piece) {
+            constexpr Piece P = decltype(piece)::value;
+            auto& grid = (pieceColor(P) == WHITE) ? white : black;
+            for (Bitboard from = pieces[P]; from; ) {
+                for (Bitboard targets = attacksOf<P>(popLsb(from), occupied); targets; ) {
+                    int to = popLsb(targets);
+                    grid[to / 8][to % 8]++;
+                }
+            }
+        });
+    }
+
+    // Count how many friendly pieces defend each occupied square
+    void getDefenseCounts(std::array<std::array<int,8>,8>& white,
+                          std::array<std::array<int,8>,8>& black) const {
+        PROFILE_SCOPE("Board::getDefenseCounts");
+        // A defender is an attacker of a square holding a piece of its own color
+        for (int sq = 0; sq < 64; sq++) {
+            Bitboard bit = squareBit(sq);
+            white[sq / 8][sq % 8] = (colors[WHITE] & bit) ? attackCount[WHITE][sq] : 0;
+            black[sq / 8][sq % 8] = (colors[BLACK] & bit) ? attackCount[BLACK][sq] : 0;
+        }
+    }
+};
+
+static_assert(std::is_trivially_copyable<Board>::value,
+              "Board must stay trivially copyable so it can be memcpy'd and kept in arrays");
+static_assert(sizeof(Board) <= 336,
+              "Board is copied on every analysis submit, search split and perft worker; "
+              "keep per-game state such as KeyHistory outside it");
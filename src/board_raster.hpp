@@ -0,0 +1,149 @@
+#pragma once
+
+#include "board.hpp"
+#include "board_style.hpp"
+#include "heatmap_cache.hpp"
+#include "heatmap_color.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// ============================================================================
+// BoardRasterizer — draws a position straight into an RGBA pixel buffer on
+// the CPU, with no window or GL context. The picture matches the Renderer's
+// board area: squares, the heat overlay of the view mode, the check
+// highlight and the pieces, all in the colours from board_style.hpp.
+//
+// Piece images are scaled to the tile size once, up front; render() is then
+// const and can run on many threads at once.
+// ============================================================================
+
+class BoardRasterizer {
+public:
+    explicit BoardRasterizer(int tileSize) : tile(tileSize) {}
+
+    int tileSize() const { return tile; }
+    int imageSize() const { return tile * 8; }
+    size_t bufferBytes() const { return static_cast<size_t>(imageSize()) * imageSize() * 4; }
+
+    // Scale a straight-alpha RGBA image to one tile. Each tile pixel
+    // averages the source pixels it covers, weighted by alpha, so edges stay
+    // clean when the source is much larger than the tile.
+    void setPieceImage(Piece p, const uint8_t* rgba, unsigned width, unsigned height) {
+        std::vector<uint8_t>& out = pieces[p];
+        out.assign(static_cast<size_t>(tile) * tile * 4, 0);
+        for (int y = 0; y < tile; y++) {
+            unsigned y0 = y * height / tile, y1 = std::max(y0 + 1, (y + 1) * height / tile);
+            for (int x = 0; x < tile; x++) {
+                unsigned x0 = x * width / tile, x1 = std::max(x0 + 1, (x + 1) * width / tile);
+                uint64_t r = 0, g = 0, b = 0, a = 0, n = 0;
+                for (unsigned sy = y0; sy < y1; sy++)
+                    for (unsigned sx = x0; sx < x1; sx++) {
+                        const uint8_t* px = rgba + (static_cast<size_t>(sy) * width + sx) * 4;
+                        r += px[0] * px[3];
+                        g += px[1] * px[3];
+                        b += px[2] * px[3];
+                        a += px[3];
+                        n++;
+                    }
+                // Stored premultiplied, which is what the blend below wants
+                uint8_t* dst = out.data() + (static_cast<size_t>(y) * tile + x) * 4;
+                dst[0] = static_cast<uint8_t>((r / 255 + n / 2) / n);
+                dst[1] = static_cast<uint8_t>((g / 255 + n / 2) / n);
+                dst[2] = static_cast<uint8_t>((b / 255 + n / 2) / n);
+                dst[3] = static_cast<uint8_t>((a + n / 2) / n);
+            }
+        }
+    }
+
+    bool hasPieceImages() const {
+        for (int p = W_PAWN; p <= B_QUEEN; p++)
+            if (pieces[p].empty()) return false;
+        return true;
+    }
+
+    // Draw board into rgba, which holds bufferBytes(). heat, if given, are
+    // the position's heat maps; otherwise they are computed when the view
+    // mode needs them.
+    void render(const Board& board, ViewMode viewMode, uint8_t* rgba,
+                const PackedHeatMaps* heat = nullptr) const {
+        for (int row = 0; row < 8; row++)
+            for (int col = 0; col < 8; col++)
+                fillSquare(rgba, row, col,
+                           isLightSquare(row, col) ? LIGHT_SQUARE_COLOR : DARK_SQUARE_COLOR);
+
+        if (viewMode == VIEW_ATTACK || viewMode == VIEW_DEFENDER) {
+            PackedHeatMaps computed;
+            if (!heat) {
+                computeHeatMaps(board, computed);
+                heat = &computed;
+            }
+            uint8_t colors[256];
+            if (viewMode == VIEW_ATTACK)
+                attackHeatToRgba(*heat, colors);
+            else
+                defenderHeatToRgba(*heat, board.colors[WHITE], board.colors[BLACK], colors);
+            for (int sq = 0; sq < 64; sq++) {
+                const uint8_t* c = colors + sq * 4;
+                if (c[3]) fillSquare(rgba, sq / 8, sq % 8, {c[0], c[1], c[2], c[3]});
+            }
+        }
+
+        if (!board.gameOver && board.isInCheck(board.sideToMove)) {
+            auto [kr, kc] = board.findKing(board.sideToMove);
+            fillSquare(rgba, kr, kc, CHECK_COLOR);
+        }
+
+        for (int row = 0; row < 8; row++)
+            for (int col = 0; col < 8; col++)
+                if (board.squares[row][col] != EMPTY)
+                    drawPiece(rgba, row, col, board.squares[row][col]);
+    }
+
+private:
+    int tile;
+    std::vector<uint8_t> pieces[13]; // premultiplied tile-sized RGBA, by Piece
+
+    static uint8_t mix(unsigned src, unsigned dst, unsigned alpha) {
+        return static_cast<uint8_t>((src * alpha + dst * (255 - alpha) + 127) / 255);
+    }
+
+    void fillSquare(uint8_t* rgba, int row, int col, StyleColor c) const {
+        const int stride = imageSize() * 4;
+        uint8_t* line = rgba + squareTop(row, tile) * stride + squareLeft(col, tile) * 4;
+        for (int y = 0; y < tile; y++, line += stride) {
+            if (c.a == 255) {
+                for (int x = 0; x < tile; x++) {
+                    uint8_t* px = line + x * 4;
+                    px[0] = c.r; px[1] = c.g; px[2] = c.b; px[3] = 255;
+                }
+            } else {
+                for (int x = 0; x < tile; x++) {
+                    uint8_t* px = line + x * 4;
+                    px[0] = mix(c.r, px[0], c.a);
+                    px[1] = mix(c.g, px[1], c.a);
+                    px[2] = mix(c.b, px[2], c.a);
+                }
+            }
+        }
+    }
+
+    // Premultiplied "over" onto the opaque board
+    void drawPiece(uint8_t* rgba, int row, int col, Piece p) const {
+        const std::vector<uint8_t>& image = pieces[p];
+        if (image.empty()) return;
+        const int stride = imageSize() * 4;
+        uint8_t* line = rgba + squareTop(row, tile) * stride + squareLeft(col, tile) * 4;
+        const uint8_t* src = image.data();
+        for (int y = 0; y < tile; y++, line += stride) {
+            for (int x = 0; x < tile; x++, src += 4) {
+                unsigned a = src[3];
+                if (a == 0) continue;
+                uint8_t* px = line + x * 4;
+                for (int i = 0; i < 3; i++)
+                    px[i] = static_cast<uint8_t>(src[i] + (px[i] * (255 - a) + 127) / 255);
+            }
+        }
+    }
+};
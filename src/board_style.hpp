@@ -0,0 +1,58 @@
+#pragma once
+
+#include "board.hpp"
+
+#include <cstdint>
+
+// ============================================================================
+// Board style — the view modes, the colours of everything drawn on the board
+// and the piece image files, shared by the window Renderer and the headless
+// rasterizer so both produce the same picture
+// ============================================================================
+
+enum ViewMode { VIEW_NORMAL, VIEW_ATTACK, VIEW_DEFENDER, VIEW_PRESSURE };
+
+struct StyleColor {
+    uint8_t r, g, b, a;
+};
+
+constexpr StyleColor LIGHT_SQUARE_COLOR = {240, 217, 181, 255};
+constexpr StyleColor DARK_SQUARE_COLOR  = {181, 136,  99, 255};
+constexpr StyleColor SELECTED_COLOR     = {255, 255,   0, 100};
+constexpr StyleColor CHECK_COLOR        = {255,   0,   0, 120}; // king of the side in check
+constexpr StyleColor MOVE_MARKER_COLOR  = {  0,   0,   0,  80}; // legal move dots and rings
+
+inline bool isLightSquare(int row, int col) { return (row + col) % 2 == 0; }
+
+// Row 0 (rank 1) is at the bottom of the picture
+inline int squareTop(int row, int tileSize) { return (7 - row) * tileSize; }
+inline int squareLeft(int col, int tileSize) { return col * tileSize; }
+
+// Piece images, relative to the project root
+struct PieceImageFile {
+    Piece piece;
+    const char* path;
+};
+
+constexpr PieceImageFile PIECE_IMAGE_FILES[12] = {
+    {W_PAWN,   "assets/white_pieces/white-pawn.png"},
+    {W_KNIGHT, "assets/white_pieces/white-knight.png"},
+    {W_BISHOP, "assets/white_pieces/white-bishop.png"},
+    {W_ROOK,   "assets/white_pieces/white-rook.png"},
+    {W_KING,   "assets/white_pieces/white-king.png"},
+    {W_QUEEN,  "assets/white_pieces/white-queen.png"},
+    {B_PAWN,   "assets/black_pieces/black-pawn.png"},
+    {B_KNIGHT, "assets/black_pieces/black-knight.png"},
+    {B_BISHOP, "assets/black_pieces/black-bishop.png"},
+    {B_ROOK,   "assets/black_pieces/black-rook.png"},
+    {B_KING,   "assets/black_pieces/black-king.png"},
+    {B_QUEEN,  "assets/black_pieces/black-queen.png"},
+};
+
+// The piece atlas: one square cell per piece, white pieces on the top row
+// and black on the bottom, each row in Piece enum order
+const unsigned PIECE_ATLAS_COLUMNS = 6;
+const unsigned PIECE_ATLAS_ROWS = 2;
+
+inline unsigned atlasColumn(Piece p) { return (p - W_PAWN) % PIECE_ATLAS_COLUMNS; }
+inline unsigned atlasRow(Piece p) { return (p - W_PAWN) / PIECE_ATLAS_COLUMNS; }
@@ -1,776 +1,270 @@
+#include "analysis_worker.hpp"
+#include "board.hpp"
+#include "profiler.hpp"
+#include "renderer.hpp"
+#include "timeline.hpp"
+
 #include <SFML/Graphics.hpp>
-#include <array>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <new>
 #include <optional>
 #include <string>
 #include <vector>
 
-// ============================================================================
-// Piece Enum + Helpers
-// ============================================================================
-
-enum Piece {
-    EMPTY    = 0,
-    W_PAWN   = 1,
-    W_KNIGHT = 2,
-    W_BISHOP = 3,
-    W_ROOK   = 4,
-    W_KING   = 5,
-    W_QUEEN  = 6,
-    B_PAWN   = 7,
-    B_KNIGHT = 8,
-    B_BISHOP = 9,
-    B_ROOK   = 10,
-    B_KING   = 11,
-    B_QUEEN  = 12
-};
-
-enum Color { WHITE, BLACK, NONE };
-
-Color pieceColor(Piece p) {
-    if (p >= W_PAWN && p <= W_QUEEN) return WHITE;
-    if (p >= B_PAWN && p <= B_QUEEN) return BLACK;
-    return NONE;
+#ifdef CHESS_PROFILE
+// Count every heap allocation for the profiler's per-frame totals
+void* operator new(std::size_t size) {
+    profileAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
 }
-
-bool isWhite(Piece p) { return pieceColor(p) == WHITE; }
-bool isBlack(Piece p) { return pieceColor(p) == BLACK; }
-
-enum ViewMode { VIEW_NORMAL, VIEW_ATTACK, VIEW_DEFENDER };
-
-struct Move {
-    int fromRow, fromCol;
-    int toRow, toCol;
-};
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    profileAllocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#endif
 
 // ============================================================================
-// Board Class — Game state and rules
+// Game Class — Input handling + main loop (SFML 3.x event API)
 // ============================================================================
 
-class Board {
+class Game {
 public:
-    std::array<std::array<Piece, 8>, 8> squares;
-    Color sideToMove;
-    bool castleWK, castleWQ, castleBK, castleBQ;
-    int enPassantCol; // -1 if none
-    bool gameOver;
-    std::string resultText;
-
-    Board() { reset(); }
-
-    void reset() {
-        for (auto& row : squares)
-            row.fill(EMPTY);
-
-        squares[0][0] = W_ROOK;   squares[0][1] = W_KNIGHT;
-        squares[0][2] = W_BISHOP; squares[0][3] = W_QUEEN;
-        squares[0][4] = W_KING;   squares[0][5] = W_BISHOP;
-        squares[0][6] = W_KNIGHT; squares[0][7] = W_ROOK;
-        for (int c = 0; c < 8; c++) squares[1][c] = W_PAWN;
-
-        squares[7][0] = B_ROOK;   squares[7][1] = B_KNIGHT;
-        squares[7][2] = B_BISHOP; squares[7][3] = B_QUEEN;
-        squares[7][4] = B_KING;   squares[7][5] = B_BISHOP;
-        squares[7][6] = B_KNIGHT; squares[7][7] = B_ROOK;
-        for (int c = 0; c < 8; c++) squares[6][c] = B_PAWN;
-
-        sideToMove = WHITE;
-        castleWK = castleWQ = castleBK = castleBQ = true;
-        enPassantCol = -1;
-        gameOver = false;
-        resultText = "";
-    }
-
-    bool inBounds(int r, int c) const {
-        return r >= 0 && r < 8 && c >= 0 && c < 8;
-    }
-
-    std::pair<int,int> findKing(Color col) const {
-        Piece king = (col == WHITE) ? W_KING : B_KING;
-        for (int r = 0; r < 8; r++)
-            for (int c = 0; c < 8; c++)
-                if (squares[r][c] == king) return {r, c};
-        return {-1, -1};
-    }
+    sf::RenderWindow window;
+    HeatMapFile openingTable; // built by openingdb; optional, used by timeline
+    GameTimeline timeline;  // every move played, with undo/redo and seeking
+    const Board& board;     // the position at the timeline's current ply
+    Renderer renderer;
 
-    bool isSquareAttackedBy(int r, int c, Color attacker) const {
-        // Knight attacks
-        int knightDr[] = {-2,-2,-1,-1,1,1,2,2};
-        int knightDc[] = {-1,1,-2,2,-2,2,-1,1};
-        Piece enemyKnight = (attacker == WHITE) ? W_KNIGHT : B_KNIGHT;
-        for (int i = 0; i < 8; i++) {
-            int nr = r + knightDr[i], nc = c + knightDc[i];
-            if (inBounds(nr, nc) && squares[nr][nc] == enemyKnight)
-                return true;
-        }
+    ViewMode viewMode;
+    bool dragging;
+    int selRow, selCol;
+    float dragX, dragY;
+    MoveList legalFromSelected;
+    bool scrubbing = false;         // dragging along the timeline bar
+    AnalysisWorker analyzer;        // computes PositionAnalysis off the UI thread
+    uint64_t submittedKey = 0;      // position last handed to the analyzer
+    int submittedDepth = 0;         // pressure depth asked for with it
+    const PositionAnalysis* shownAnalysis = nullptr; // what the last frame drew
+    int pressureDepth = 3;          // plies the pressure view looks ahead (Up/Down)
+
+    // Redraws happen only when something on screen changed, at most once
+    // per FRAME_INTERVAL; in between, the loop sleeps in waitEvent.
+    static constexpr int FRAME_INTERVAL_US = 16667; // ~60 fps cap while dragging
+    bool dirty = true;
+    bool showStats = false; // toggled with S
+#ifdef CHESS_PROFILE
+    bool showProfile = false; // toggled with P; T writes a Chrome trace
+    static constexpr const char* TRACE_PATH = "chess-trace.json";
+#endif
+    FrameStats stats;
+    sf::Clock sinceLastFrame;
 
-        // Pawn attacks
-        Piece enemyPawn = (attacker == WHITE) ? W_PAWN : B_PAWN;
-        int pawnDir = (attacker == WHITE) ? -1 : 1;
-        for (int dc : {-1, 1}) {
-            int nr = r + pawnDir, nc = c + dc;
-            if (inBounds(nr, nc) && squares[nr][nc] == enemyPawn)
-                return true;
-        }
+    Game() : window(sf::VideoMode({static_cast<unsigned>(Renderer::BOARD_PX),
+                                    static_cast<unsigned>(Renderer::BOARD_PX + Renderer::STATUS_HEIGHT)}),
+                    "Chess"),
+             board(timeline.board()), viewMode(VIEW_NORMAL), dragging(false), selRow(-1), selCol(-1), dragX(0), dragY(0) {}
 
-        // King attacks
-        Piece enemyKing = (attacker == WHITE) ? W_KING : B_KING;
-        for (int dr = -1; dr <= 1; dr++)
-            for (int dc = -1; dc <= 1; dc++) {
-                if (dr == 0 && dc == 0) continue;
-                int nr = r + dr, nc = c + dc;
-                if (inBounds(nr, nc) && squares[nr][nc] == enemyKing)
-                    return true;
-            }
+    bool init() { return renderer.loadAssets(); }
 
-        // Rook/Queen along ranks and files
-        Piece enemyRook  = (attacker == WHITE) ? W_ROOK  : B_ROOK;
-        Piece enemyQueen = (attacker == WHITE) ? W_QUEEN : B_QUEEN;
-        int straightDr[] = {-1,1,0,0};
-        int straightDc[] = {0,0,-1,1};
-        for (int d = 0; d < 4; d++) {
-            for (int step = 1; step < 8; step++) {
-                int nr = r + straightDr[d]*step;
-                int nc = c + straightDc[d]*step;
-                if (!inBounds(nr, nc)) break;
-                Piece p = squares[nr][nc];
-                if (p != EMPTY) {
-                    if (p == enemyRook || p == enemyQueen) return true;
-                    break;
-                }
-            }
-        }
+    // Draw and show the first frame now rather than when run() starts
+    void renderFirstFrame() { render(); }
 
-        // Bishop/Queen along diagonals
-        Piece enemyBishop = (attacker == WHITE) ? W_BISHOP : B_BISHOP;
-        int diagDr[] = {-1,-1,1,1};
-        int diagDc[] = {-1,1,-1,1};
-        for (int d = 0; d < 4; d++) {
-            for (int step = 1; step < 8; step++) {
-                int nr = r + diagDr[d]*step;
-                int nc = c + diagDc[d]*step;
-                if (!inBounds(nr, nc)) break;
-                Piece p = squares[nr][nc];
-                if (p != EMPTY) {
-                    if (p == enemyBishop || p == enemyQueen) return true;
-                    break;
-                }
-            }
+    // Take heat maps of positions in this opening table from the file
+    // rather than computing them
+    bool loadOpenings(const std::string& path) {
+        if (!openingTable.open(path, MappedFile::RANDOM) || !openingTable.sorted()) {
+            std::cerr << "Not a sorted heat-map file: " << path << std::endl;
+            return false;
         }
-
-        return false;
-    }
-
-    bool isInCheck(Color col) const {
-        auto [kr, kc] = findKing(col);
-        Color enemy = (col == WHITE) ? BLACK : WHITE;
-        return isSquareAttackedBy(kr, kc, enemy);
+        timeline.useHeatMapTable(&openingTable);
+        return true;
     }
 
-    void generatePieceMoves(int r, int c, std::vector<Move>& moves) const {
-        Piece p = squares[r][c];
-        Color col = pieceColor(p);
-        if (col == NONE) return;
-
-        auto addIfValid = [&](int tr, int tc) {
-            if (!inBounds(tr, tc)) return;
-            Piece target = squares[tr][tc];
-            if (target != EMPTY && pieceColor(target) == col) return;
-            moves.push_back({r, c, tr, tc});
-        };
-
-        auto addSliding = [&](int dr, int dc) {
-            for (int step = 1; step < 8; step++) {
-                int nr = r + dr*step, nc = c + dc*step;
-                if (!inBounds(nr, nc)) break;
-                Piece target = squares[nr][nc];
-                if (target != EMPTY) {
-                    if (pieceColor(target) != col)
-                        moves.push_back({r, c, nr, nc});
-                    break;
+    void run() {
+        const sf::Time frameInterval = sf::microseconds(FRAME_INTERVAL_US);
+        while (window.isOpen()) {
+            // Redraw whenever the worker publishes something new for the
+            // shown position: its analysis, then any pressure map
+            const PositionAnalysis* analysis = currentAnalysis();
+            if (analysis != shownAnalysis) dirty = true;
+            bool waiting = !analysis || (viewMode == VIEW_PRESSURE && !analysis->hasPressure);
+
+            // Nothing to draw: block until an event arrives. A pending
+            // redraw inside the frame cap: wait only until the next slot.
+            // Still waiting on the worker: check back after one frame.
+            sf::Time timeout = sf::Time::Zero; // Zero waits indefinitely
+            if (dirty) {
+                sf::Time elapsed = sinceLastFrame.getElapsedTime();
+                if (elapsed >= frameInterval) {
+                    render();
+                    PROFILE_FRAME();
+                    continue;
                 }
-                moves.push_back({r, c, nr, nc});
+                timeout = frameInterval - elapsed;
+            } else if (waiting) {
+                timeout = frameInterval;
             }
-        };
 
-        switch (p) {
-        case W_PAWN: {
-            if (inBounds(r+1, c) && squares[r+1][c] == EMPTY) {
-                moves.push_back({r, c, r+1, c});
-                if (r == 1 && squares[r+2][c] == EMPTY)
-                    moves.push_back({r, c, r+2, c});
+            if (const std::optional event = window.waitEvent(timeout)) {
+                PROFILE_SCOPE("Game::handleEvents");
+                handleEvent(*event);
+                while (const std::optional more = window.pollEvent())
+                    handleEvent(*more);
             }
-            for (int dc : {-1, 1}) {
-                int nc = c + dc;
-                if (!inBounds(r+1, nc)) continue;
-                if (squares[r+1][nc] != EMPTY && isBlack(squares[r+1][nc]))
-                    moves.push_back({r, c, r+1, nc});
-                if (r == 4 && nc == enPassantCol && squares[r+1][nc] == EMPTY)
-                    moves.push_back({r, c, r+1, nc});
-            }
-            break;
-        }
-        case B_PAWN: {
-            if (inBounds(r-1, c) && squares[r-1][c] == EMPTY) {
-                moves.push_back({r, c, r-1, c});
-                if (r == 6 && squares[r-2][c] == EMPTY)
-                    moves.push_back({r, c, r-2, c});
-            }
-            for (int dc : {-1, 1}) {
-                int nc = c + dc;
-                if (!inBounds(r-1, nc)) continue;
-                if (squares[r-1][nc] != EMPTY && isWhite(squares[r-1][nc]))
-                    moves.push_back({r, c, r-1, nc});
-                if (r == 3 && nc == enPassantCol && squares[r-1][nc] == EMPTY)
-                    moves.push_back({r, c, r-1, nc});
-            }
-            break;
-        }
-        case W_KNIGHT: case B_KNIGHT: {
-            int dr[] = {-2,-2,-1,-1,1,1,2,2};
-            int dc[] = {-1,1,-2,2,-2,2,-1,1};
-            for (int i = 0; i < 8; i++) addIfValid(r+dr[i], c+dc[i]);
-            break;
-        }
-        case W_BISHOP: case B_BISHOP: {
-            for (auto [dr,dc] : std::vector<std::pair<int,int>>{{-1,-1},{-1,1},{1,-1},{1,1}})
-                addSliding(dr, dc);
-            break;
-        }
-        case W_ROOK: case B_ROOK: {
-            for (auto [dr,dc] : std::vector<std::pair<int,int>>{{-1,0},{1,0},{0,-1},{0,1}})
-                addSliding(dr, dc);
-            break;
-        }
-        case W_QUEEN: case B_QUEEN: {
-            for (auto [dr,dc] : std::vector<std::pair<int,int>>{{-1,-1},{-1,0},{-1,1},{0,-1},{0,1},{1,-1},{1,0},{1,1}})
-                addSliding(dr, dc);
-            break;
-        }
-        case W_KING: case B_KING: {
-            for (int dr = -1; dr <= 1; dr++)
-                for (int dc = -1; dc <= 1; dc++) {
-                    if (dr == 0 && dc == 0) continue;
-                    addIfValid(r+dr, c+dc);
-                }
-            // Castling
-            if (col == WHITE && r == 0 && c == 4 && !isInCheck(WHITE)) {
-                if (castleWK && squares[0][5] == EMPTY && squares[0][6] == EMPTY
-                    && squares[0][7] == W_ROOK
-                    && !isSquareAttackedBy(0, 5, BLACK)
-                    && !isSquareAttackedBy(0, 6, BLACK))
-                    moves.push_back({0, 4, 0, 6});
-                if (castleWQ && squares[0][3] == EMPTY && squares[0][2] == EMPTY
-                    && squares[0][1] == EMPTY && squares[0][0] == W_ROOK
-                    && !isSquareAttackedBy(0, 3, BLACK)
-                    && !isSquareAttackedBy(0, 2, BLACK))
-                    moves.push_back({0, 4, 0, 2});
-            }
-            if (col == BLACK && r == 7 && c == 4 && !isInCheck(BLACK)) {
-                if (castleBK && squares[7][5] == EMPTY && squares[7][6] == EMPTY
-                    && squares[7][7] == B_ROOK
-                    && !isSquareAttackedBy(7, 5, WHITE)
-                    && !isSquareAttackedBy(7, 6, WHITE))
-                    moves.push_back({7, 4, 7, 6});
-                if (castleBQ && squares[7][3] == EMPTY && squares[7][2] == EMPTY
-                    && squares[7][1] == EMPTY && squares[7][0] == B_ROOK
-                    && !isSquareAttackedBy(7, 3, WHITE)
-                    && !isSquareAttackedBy(7, 2, WHITE))
-                    moves.push_back({7, 4, 7, 2});
-            }
-            break;
-        }
-        default: break;
         }
     }
 
-    std::vector<Move> getLegalMoves(int r, int c) const {
-        std::vector<Move> pseudo;
-        generatePieceMoves(r, c, pseudo);
-
-        std::vector<Move> legal;
-        Color col = pieceColor(squares[r][c]);
-        for (auto& m : pseudo) {
-            Board copy = *this;
-            copy.applyMoveRaw(m);
-            if (!copy.isInCheck(col))
-                legal.push_back(m);
-        }
-        return legal;
-    }
-
-    std::vector<Move> getAllLegalMoves() const {
-        std::vector<Move> all;
-        for (int r = 0; r < 8; r++)
-            for (int c = 0; c < 8; c++)
-                if (pieceColor(squares[r][c]) == sideToMove) {
-                    auto moves = getLegalMoves(r, c);
-                    all.insert(all.end(), moves.begin(), moves.end());
-                }
-        return all;
+private:
+    // Mark the screen out of date. Requests made while a frame is already
+    // pending are folded into it and counted as skipped frames.
+    void requestFrame() {
+        if (dirty) stats.skipped++;
+        dirty = true;
     }
 
-    void applyMoveRaw(const Move& m) {
-        Piece p = squares[m.fromRow][m.fromCol];
-
-        // En passant capture
-        if ((p == W_PAWN || p == B_PAWN) && m.fromCol != m.toCol
-            && squares[m.toRow][m.toCol] == EMPTY) {
-            squares[m.fromRow][m.toCol] = EMPTY;
+    void handleEvent(const sf::Event& event) {
+        if (event.is<sf::Event::Closed>()) {
+            window.close();
+            return;
         }
-
-        // Castling — move the rook
-        if ((p == W_KING || p == B_KING) && std::abs(m.toCol - m.fromCol) == 2) {
-            int row = m.fromRow;
-            if (m.toCol == 6) {
-                squares[row][5] = squares[row][7];
-                squares[row][7] = EMPTY;
-            } else {
-                squares[row][3] = squares[row][0];
-                squares[row][0] = EMPTY;
-            }
+        if (event.is<sf::Event::Resized>() || event.is<sf::Event::FocusGained>()
+            || event.is<sf::Event::MouseEntered>()) {
+            requestFrame(); // the window contents may have been lost
+            return;
         }
-
-        squares[m.toRow][m.toCol] = p;
-        squares[m.fromRow][m.fromCol] = EMPTY;
-
-        // Promotion (auto-queen)
-        if (p == W_PAWN && m.toRow == 7)
-            squares[m.toRow][m.toCol] = W_QUEEN;
-        if (p == B_PAWN && m.toRow == 0)
-            squares[m.toRow][m.toCol] = B_QUEEN;
-    }
-
-    void makeMove(const Move& m) {
-        Piece p = squares[m.fromRow][m.fromCol];
-        applyMoveRaw(m);
-
-        // Update en passant
-        enPassantCol = -1;
-        if (p == W_PAWN && m.toRow - m.fromRow == 2)
-            enPassantCol = m.fromCol;
-        if (p == B_PAWN && m.fromRow - m.toRow == 2)
-            enPassantCol = m.fromCol;
-
-        // Update castling rights
-        if (p == W_KING)   { castleWK = false; castleWQ = false; }
-        if (p == B_KING)   { castleBK = false; castleBQ = false; }
-        if (p == W_ROOK && m.fromRow == 0 && m.fromCol == 0) castleWQ = false;
-        if (p == W_ROOK && m.fromRow == 0 && m.fromCol == 7) castleWK = false;
-        if (p == B_ROOK && m.fromRow == 7 && m.fromCol == 0) castleBQ = false;
-        if (p == B_ROOK && m.fromRow == 7 && m.fromCol == 7) castleBK = false;
-
-        // If a rook is captured on its starting square
-        if (m.toRow == 0 && m.toCol == 0) castleWQ = false;
-        if (m.toRow == 0 && m.toCol == 7) castleWK = false;
-        if (m.toRow == 7 && m.toCol == 0) castleBQ = false;
-        if (m.toRow == 7 && m.toCol == 7) castleBK = false;
-
-        sideToMove = (sideToMove == WHITE) ? BLACK : WHITE;
-
-        if (getAllLegalMoves().empty()) {
-            gameOver = true;
-            if (isInCheck(sideToMove)) {
-                resultText = (sideToMove == WHITE) ? "Black wins by checkmate!"
-                                                   : "White wins by checkmate!";
-            } else {
-                resultText = "Stalemate — draw!";
+        if (const auto* kp = event.getIf<sf::Event::KeyPressed>()) {
+            if (kp->code == sf::Keyboard::Key::Num1) setViewMode(VIEW_NORMAL);
+            else if (kp->code == sf::Keyboard::Key::Num2) setViewMode(VIEW_ATTACK);
+            else if (kp->code == sf::Keyboard::Key::Num3) setViewMode(VIEW_DEFENDER);
+            else if (kp->code == sf::Keyboard::Key::Num4) setViewMode(VIEW_PRESSURE);
+            else if (viewMode == VIEW_PRESSURE && kp->code == sf::Keyboard::Key::Up)
+                setPressureDepth(pressureDepth + 1);
+            else if (viewMode == VIEW_PRESSURE && kp->code == sf::Keyboard::Key::Down)
+                setPressureDepth(pressureDepth - 1);
+            else if (kp->code == sf::Keyboard::Key::S) {
+                showStats = !showStats;
+                requestFrame();
             }
-        }
-    }
-
-    // Count how many white/black pieces attack each square (pseudo-legal)
-    void getAttackCounts(std::array<std::array<int,8>,8>& white,
-                         std::array<std::array<int,8>,8>& black) const {
-        for (auto& row : white) row.fill(0);
-        for (auto& row : black) row.fill(0);
-
-        for (int r = 0; r < 8; r++)
-            for (int c = 0; c < 8; c++) {
-                Piece p = squares[r][c];
-                Color col = pieceColor(p);
-                if (col == NONE) continue;
-                auto& grid = (col == WHITE) ? white : black;
-
-                auto markSliding = [&](int dr, int dc) {
-                    for (int step = 1; step < 8; step++) {
-                        int nr = r + dr*step, nc = c + dc*step;
-                        if (!inBounds(nr, nc)) break;
-                        grid[nr][nc]++;
-                        if (squares[nr][nc] != EMPTY) break;
-                    }
-                };
-
-                switch (p) {
-                case W_PAWN:
-                    for (int dc : {-1, 1})
-                        if (inBounds(r+1, c+dc)) grid[r+1][c+dc]++;
-                    break;
-                case B_PAWN:
-                    for (int dc : {-1, 1})
-                        if (inBounds(r-1, c+dc)) grid[r-1][c+dc]++;
-                    break;
-                case W_KNIGHT: case B_KNIGHT: {
-                    int dr[] = {-2,-2,-1,-1,1,1,2,2};
-                    int dc[] = {-1,1,-2,2,-2,2,-1,1};
-                    for (int i = 0; i < 8; i++) {
-                        int nr = r+dr[i], nc = c+dc[i];
-                        if (inBounds(nr, nc)) grid[nr][nc]++;
-                    }
-                    break;
-                }
-                case W_BISHOP: case B_BISHOP:
-                    for (auto [dr,dc] : std::vector<std::pair<int,int>>{{-1,-1},{-1,1},{1,-1},{1,1}})
-                        markSliding(dr, dc);
-                    break;
-                case W_ROOK: case B_ROOK:
-                    for (auto [dr,dc] : std::vector<std::pair<int,int>>{{-1,0},{1,0},{0,-1},{0,1}})
-                        markSliding(dr, dc);
-                    break;
-                case W_QUEEN: case B_QUEEN:
-                    for (auto [dr,dc] : std::vector<std::pair<int,int>>{{-1,-1},{-1,0},{-1,1},{0,-1},{0,1},{1,-1},{1,0},{1,1}})
-                        markSliding(dr, dc);
-                    break;
-                case W_KING: case B_KING:
-                    for (int dr = -1; dr <= 1; dr++)
-                        for (int dc = -1; dc <= 1; dc++) {
-                            if (dr == 0 && dc == 0) continue;
-                            if (inBounds(r+dr, c+dc)) grid[r+dr][c+dc]++;
-                        }
-                    break;
-                default: break;
-                }
+#ifdef CHESS_PROFILE
+            else if (kp->code == sf::Keyboard::Key::P) {
+                showProfile = !showProfile;
+                requestFrame();
+            } else if (kp->code == sf::Keyboard::Key::T) {
+                if (Profiler::instance().writeChromeTrace(TRACE_PATH))
+                    std::cout << "Wrote " << TRACE_PATH << std::endl;
+                else
+                    std::cerr << "Failed to write " << TRACE_PATH << std::endl;
             }
-    }
-
-    // Count how many friendly pieces defend each occupied square
-    void getDefenseCounts(std::array<std::array<int,8>,8>& white,
-                          std::array<std::array<int,8>,8>& black) const {
-        for (auto& row : white) row.fill(0);
-        for (auto& row : black) row.fill(0);
-
-        for (int r = 0; r < 8; r++)
-            for (int c = 0; c < 8; c++) {
-                Piece p = squares[r][c];
-                Color col = pieceColor(p);
-                if (col == NONE) continue;
-                auto& grid = (col == WHITE) ? white : black;
-
-                auto markSliding = [&](int dr, int dc) {
-                    for (int step = 1; step < 8; step++) {
-                        int nr = r + dr*step, nc = c + dc*step;
-                        if (!inBounds(nr, nc)) break;
-                        Piece target = squares[nr][nc];
-                        if (target != EMPTY) {
-                            if (pieceColor(target) == col)
-                                grid[nr][nc]++;
-                            break;
-                        }
-                    }
-                };
-
-                switch (p) {
-                case W_PAWN:
-                    for (int dc : {-1, 1})
-                        if (inBounds(r+1, c+dc) && pieceColor(squares[r+1][c+dc]) == WHITE)
-                            grid[r+1][c+dc]++;
-                    break;
-                case B_PAWN:
-                    for (int dc : {-1, 1})
-                        if (inBounds(r-1, c+dc) && pieceColor(squares[r-1][c+dc]) == BLACK)
-                            grid[r-1][c+dc]++;
-                    break;
-                case W_KNIGHT: case B_KNIGHT: {
-                    int dr[] = {-2,-2,-1,-1,1,1,2,2};
-                    int dc[] = {-1,1,-2,2,-2,2,-1,1};
-                    for (int i = 0; i < 8; i++) {
-                        int nr = r+dr[i], nc = c+dc[i];
-                        if (inBounds(nr, nc) && pieceColor(squares[nr][nc]) == col)
-                            grid[nr][nc]++;
-                    }
-                    break;
-                }
-                case W_BISHOP: case B_BISHOP:
-                    for (auto [dr,dc] : std::vector<std::pair<int,int>>{{-1,-1},{-1,1},{1,-1},{1,1}})
-                        markSliding(dr, dc);
-                    break;
-                case W_ROOK: case B_ROOK:
-                    for (auto [dr,dc] : std::vector<std::pair<int,int>>{{-1,0},{1,0},{0,-1},{0,1}})
-                        markSliding(dr, dc);
-                    break;
-                case W_QUEEN: case B_QUEEN:
-                    for (auto [dr,dc] : std::vector<std::pair<int,int>>{{-1,-1},{-1,0},{-1,1},{0,-1},{0,1},{1,-1},{1,0},{1,1}})
-                        markSliding(dr, dc);
-                    break;
-                case W_KING: case B_KING:
-                    for (int dr = -1; dr <= 1; dr++)
-                        for (int dc = -1; dc <= 1; dc++) {
-                            if (dr == 0 && dc == 0) continue;
-                            int nr = r+dr, nc = c+dc;
-                            if (inBounds(nr, nc) && pieceColor(squares[nr][nc]) == col)
-                                grid[nr][nc]++;
-                        }
-                    break;
-                default: break;
-                }
+#endif
+            else if (!dragging) {
+                // Z/Left undo, Y/Right redo, Home/End jump to either end
+                if (kp->code == sf::Keyboard::Key::Z || kp->code == sf::Keyboard::Key::Left)
+                    jumpTo(timeline.ply() - 1);
+                else if (kp->code == sf::Keyboard::Key::Y || kp->code == sf::Keyboard::Key::Right)
+                    jumpTo(timeline.ply() + 1);
+                else if (kp->code == sf::Keyboard::Key::Home)
+                    jumpTo(0);
+                else if (kp->code == sf::Keyboard::Key::End)
+                    jumpTo(timeline.length());
             }
-    }
-};
-
-// ============================================================================
-// Renderer Class — All SFML drawing (SFML 3.x API)
-// ============================================================================
+        }
 
-class Renderer {
-public:
-    static constexpr float TILE_SIZE = 80.f;
-    static constexpr float BOARD_PX = TILE_SIZE * 8;
-    static constexpr float STATUS_HEIGHT = 40.f;
-
-    sf::Texture textures[13]; // indexed by Piece enum
-    std::optional<sf::Font> font;
-
-    bool loadAssets() {
-        struct TexInfo { Piece piece; std::string path; };
-        TexInfo infos[] = {
-            {W_PAWN,   "assets/white_pieces/white-pawn.png"},
-            {W_KNIGHT, "assets/white_pieces/white-knight.png"},
-            {W_BISHOP, "assets/white_pieces/white-bishop.png"},
-            {W_ROOK,   "assets/white_pieces/white-rook.png"},
-            {W_KING,   "assets/white_pieces/white-king.png"},
-            {W_QUEEN,  "assets/white_pieces/white-queen.png"},
-            {B_PAWN,   "assets/black_pieces/black-pawn.png"},
-            {B_KNIGHT, "assets/black_pieces/black-knight.png"},
-            {B_BISHOP, "assets/black_pieces/black-bishop.png"},
-            {B_ROOK,   "assets/black_pieces/black-rook.png"},
-            {B_KING,   "assets/black_pieces/black-king.png"},
-            {B_QUEEN,  "assets/black_pieces/black-queen.png"},
-        };
-        for (auto& info : infos) {
-            if (!textures[info.piece].loadFromFile(info.path)) {
-                std::cerr << "Failed to load " << info.path << std::endl;
-                return false;
+        // The timeline bar under the status text can be clicked or dragged
+        // to scrub through the game, including after it has ended
+        if (const auto* mp = event.getIf<sf::Event::MouseButtonPressed>()) {
+            if (mp->button == sf::Mouse::Button::Left && !dragging
+                && mp->position.y >= Renderer::BOARD_PX) {
+                scrubbing = true;
+                scrubTo(mp->position.x);
+                return;
             }
         }
-        // Try loading a system font for the status bar
-        const char* fontPaths[] = {
-            "/System/Library/Fonts/Helvetica.ttc",
-            "/System/Library/Fonts/SFNSMono.ttf",
-            "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
-            "/usr/share/fonts/TTF/DejaVuSans.ttf",
-            "C:/Windows/Fonts/arial.ttf"
-        };
-        for (auto* fp : fontPaths) {
-            sf::Font tryFont;
-            if (tryFont.openFromFile(fp)) {
-                font = std::move(tryFont);
-                break;
-            }
+        if (scrubbing) {
+            if (const auto* mm = event.getIf<sf::Event::MouseMoved>())
+                scrubTo(mm->position.x);
+            if (const auto* mr = event.getIf<sf::Event::MouseButtonReleased>())
+                if (mr->button == sf::Mouse::Button::Left) scrubbing = false;
+            return;
         }
-        return true;
-    }
-
-    float rowToY(int row) const { return (7 - row) * TILE_SIZE; }
-    float colToX(int col) const { return col * TILE_SIZE; }
-    int yToRow(float y) const { return 7 - static_cast<int>(y / TILE_SIZE); }
-    int xToCol(float x) const { return static_cast<int>(x / TILE_SIZE); }
-
-    void drawBoard(sf::RenderWindow& window) {
-        for (int row = 0; row < 8; row++)
-            for (int col = 0; col < 8; col++) {
-                sf::RectangleShape sq({TILE_SIZE, TILE_SIZE});
-                sq.setPosition({colToX(col), rowToY(row)});
-                bool light = (row + col) % 2 == 0;
-                sq.setFillColor(light ? sf::Color(240, 217, 181)
-                                      : sf::Color(181, 136, 99));
-                window.draw(sq);
-            }
-    }
 
-    void drawHighlight(sf::RenderWindow& window, int row, int col,
-                       sf::Color color) {
-        sf::RectangleShape sq({TILE_SIZE, TILE_SIZE});
-        sq.setPosition({colToX(col), rowToY(row)});
-        sq.setFillColor(color);
-        window.draw(sq);
-    }
+        if (board.gameOver) return;
 
-    void drawLegalDot(sf::RenderWindow& window, int row, int col,
-                      const Board& board) {
-        float cx = colToX(col) + TILE_SIZE / 2;
-        float cy = rowToY(row) + TILE_SIZE / 2;
-        if (board.squares[row][col] != EMPTY) {
-            sf::CircleShape ring(TILE_SIZE / 2 - 4);
-            ring.setPosition({colToX(col) + 4, rowToY(row) + 4});
-            ring.setFillColor(sf::Color::Transparent);
-            ring.setOutlineThickness(4);
-            ring.setOutlineColor(sf::Color(0, 0, 0, 80));
-            window.draw(ring);
-        } else {
-            sf::CircleShape dot(10);
-            dot.setPosition({cx - 10, cy - 10});
-            dot.setFillColor(sf::Color(0, 0, 0, 80));
-            window.draw(dot);
+        if (const auto* mp = event.getIf<sf::Event::MouseButtonPressed>()) {
+            if (mp->button == sf::Mouse::Button::Left)
+                onMousePress(mp->position.x, mp->position.y);
         }
-    }
-
-    void drawPiece(sf::RenderWindow& window, Piece p, float x, float y) {
-        if (p == EMPTY) return;
-        sf::Sprite sprite(textures[p]);
-        auto sz = textures[p].getSize();
-        sprite.setScale({TILE_SIZE / sz.x, TILE_SIZE / sz.y});
-        sprite.setPosition({x, y});
-        window.draw(sprite);
-    }
-
-    void drawPieces(sf::RenderWindow& window, const Board& board,
-                    int skipRow = -1, int skipCol = -1) {
-        for (int row = 0; row < 8; row++)
-            for (int col = 0; col < 8; col++) {
-                if (row == skipRow && col == skipCol) continue;
-                drawPiece(window, board.squares[row][col],
-                          colToX(col), rowToY(row));
+        if (const auto* mm = event.getIf<sf::Event::MouseMoved>()) {
+            if (dragging) {
+                dragX = mm->position.x - Renderer::TILE_SIZE / 2;
+                dragY = mm->position.y - Renderer::TILE_SIZE / 2;
+                requestFrame();
             }
+        }
+        if (const auto* mr = event.getIf<sf::Event::MouseButtonReleased>()) {
+            if (mr->button == sf::Mouse::Button::Left && dragging)
+                onMouseRelease(mr->position.x, mr->position.y);
+        }
     }
 
-    void drawAttackHeatMap(sf::RenderWindow& window, const Board& board) {
-        std::array<std::array<int,8>,8> whiteGrid, blackGrid;
-        board.getAttackCounts(whiteGrid, blackGrid);
-        for (int row = 0; row < 8; row++)
-            for (int col = 0; col < 8; col++) {
-                int diff = whiteGrid[row][col] - blackGrid[row][col];
-                if (diff == 0) continue;
-                sf::RectangleShape sq({TILE_SIZE, TILE_SIZE});
-                sq.setPosition({colToX(col), rowToY(row)});
-                int alpha = std::min(std::abs(diff) * 60, 230);
-                if (diff > 0)
-                    sq.setFillColor(sf::Color(70, 130, 230, static_cast<uint8_t>(alpha)));
-                else
-                    sq.setFillColor(sf::Color(230, 70, 70, static_cast<uint8_t>(alpha)));
-                window.draw(sq);
-            }
+    // Analysis of the current board, or nullptr while the worker is still on
+    // it. A changed position is submitted on first ask, with its heat maps if
+    // the timeline already has them; otherwise the worker computes them and
+    // they go back into the timeline's per-ply cache, so this thread never
+    // does. The same position is submitted again when the pressure view needs
+    // a map at a depth not yet asked for.
+    const PositionAnalysis* currentAnalysis() {
+        int depth = (viewMode == VIEW_PRESSURE) ? pressureDepth : 0;
+        if (board.key != submittedKey || !submittedKey || (depth && depth != submittedDepth)) {
+            analyzer.submit(board, timeline.knownHeatMaps(), depth);
+            submittedKey = board.key;
+            submittedDepth = depth;
+        }
+        const PositionAnalysis* analysis = analyzer.latest();
+        if (analysis && analysis->key == board.key && !timeline.heatCachedAt(timeline.ply()))
+            timeline.cacheHeatMaps(analysis->heat);
+        return analysis;
     }
 
-    void drawDefenderMap(sf::RenderWindow& window, const Board& board) {
-        std::array<std::array<int,8>,8> whiteGrid, blackGrid;
-        board.getDefenseCounts(whiteGrid, blackGrid);
-        for (int row = 0; row < 8; row++)
-            for (int col = 0; col < 8; col++) {
-                Piece p = board.squares[row][col];
-                if (p == EMPTY) continue;
-                Color col2 = pieceColor(p);
-                int defenders = (col2 == WHITE) ? whiteGrid[row][col] : blackGrid[row][col];
-                sf::RectangleShape sq({TILE_SIZE, TILE_SIZE});
-                sq.setPosition({colToX(col), rowToY(row)});
-                if (defenders == 0) {
-                    sq.setFillColor(sf::Color(255, 255, 255, 140));
-                } else {
-                    int alpha = std::min(defenders * 75, 230);
-                    if (col2 == WHITE)
-                        sq.setFillColor(sf::Color(70, 130, 230, static_cast<uint8_t>(alpha)));
-                    else
-                        sq.setFillColor(sf::Color(230, 70, 70, static_cast<uint8_t>(alpha)));
-                }
-                window.draw(sq);
-            }
+    void jumpTo(int ply) {
+        ply = std::max(0, std::min(ply, timeline.length()));
+        if (ply == timeline.ply()) return;
+        timeline.seek(ply);
+        selRow = selCol = -1;
+        legalFromSelected.clear();
+        requestFrame();
     }
 
-    void drawStatusBar(sf::RenderWindow& window, const Board& board,
-                       ViewMode viewMode = VIEW_NORMAL) {
-        sf::RectangleShape bar({BOARD_PX, STATUS_HEIGHT});
-        bar.setPosition({0, BOARD_PX});
-        bar.setFillColor(sf::Color(50, 50, 50));
-        window.draw(bar);
-
-        if (!font) return;
-
-        std::string text;
-        if (board.gameOver) {
-            text = board.resultText;
-        } else {
-            text = (board.sideToMove == WHITE) ? "White to move" : "Black to move";
-            if (board.isInCheck(board.sideToMove))
-                text += " -- CHECK!";
-        }
-        if (viewMode == VIEW_ATTACK)
-            text += "  [Attack Map]";
-        else if (viewMode == VIEW_DEFENDER)
-            text += "  [Defender Map]";
-        sf::Text label(*font, text, 20);
-        label.setPosition({10.f, BOARD_PX + 8.f});
-        label.setFillColor(sf::Color::White);
-        window.draw(label);
+    void scrubTo(int x) {
+        float t = std::max(0.f, std::min(1.f, x / Renderer::BOARD_PX));
+        jumpTo(static_cast<int>(std::lround(t * timeline.length())));
     }
-};
-
-// ============================================================================
-// Game Class — Input handling + main loop (SFML 3.x event API)
-// ============================================================================
-
-class Game {
-public:
-    sf::RenderWindow window;
-    Board board;
-    Renderer renderer;
-
-    ViewMode viewMode;
-    bool dragging;
-    int selRow, selCol;
-    float dragX, dragY;
-    std::vector<Move> legalFromSelected;
-    std::vector<Board> undoHistory; // max 2 states
 
-    Game() : window(sf::VideoMode({static_cast<unsigned>(Renderer::BOARD_PX),
-                                    static_cast<unsigned>(Renderer::BOARD_PX + Renderer::STATUS_HEIGHT)}),
-                    "Chess"),
-             viewMode(VIEW_NORMAL), dragging(false), selRow(-1), selCol(-1), dragX(0), dragY(0) {}
-
-    bool init() { return renderer.loadAssets(); }
-
-    void run() {
-        while (window.isOpen()) {
-            handleEvents();
-            render();
-        }
+    void setViewMode(ViewMode mode) {
+        if (viewMode == mode) return;
+        viewMode = mode;
+        requestFrame();
     }
 
-private:
-    void handleEvents() {
-        while (const std::optional event = window.pollEvent()) {
-            if (event->is<sf::Event::Closed>()) {
-                window.close();
-                return;
-            }
-            if (const auto* kp = event->getIf<sf::Event::KeyPressed>()) {
-                if (kp->code == sf::Keyboard::Key::Num1) viewMode = VIEW_NORMAL;
-                else if (kp->code == sf::Keyboard::Key::Num2) viewMode = VIEW_ATTACK;
-                else if (kp->code == sf::Keyboard::Key::Num3) viewMode = VIEW_DEFENDER;
-                else if (kp->code == sf::Keyboard::Key::Z && !undoHistory.empty() && !dragging) {
-                    board = undoHistory.back();
-                    undoHistory.pop_back();
-                    selRow = selCol = -1;
-                    legalFromSelected.clear();
-                }
-            }
-
-            if (board.gameOver) continue;
-
-            if (const auto* mp = event->getIf<sf::Event::MouseButtonPressed>()) {
-                if (mp->button == sf::Mouse::Button::Left)
-                    onMousePress(mp->position.x, mp->position.y);
-            }
-            if (const auto* mm = event->getIf<sf::Event::MouseMoved>()) {
-                if (dragging) {
-                    dragX = mm->position.x - Renderer::TILE_SIZE / 2;
-                    dragY = mm->position.y - Renderer::TILE_SIZE / 2;
-                }
-            }
-            if (const auto* mr = event->getIf<sf::Event::MouseButtonReleased>()) {
-                if (mr->button == sf::Mouse::Button::Left && dragging)
-                    onMouseRelease(mr->position.x, mr->position.y);
-            }
-        }
+    void setPressureDepth(int depth) {
+        depth = std::max(1, std::min(depth, PressureSearch::MAX_DEPTH));
+        if (depth == pressureDepth) return;
+        pressureDepth = depth;
+        requestFrame();
     }
 
     void onMousePress(int mx, int my) {
@@ -786,19 +280,33 @@ private:
         dragging = true;
         dragX = mx - Renderer::TILE_SIZE / 2;
         dragY = my - Renderer::TILE_SIZE / 2;
-        legalFromSelected = board.getLegalMoves(row, col);
+        // Before the worker's first result for this position, generate the
+        // piece's moves directly rather than ignore the click
+        if (const PositionAnalysis* a = currentAnalysis())
+            legalFromSelected.assign(a->movesFromBegin(row, col), a->movesFromEnd(row, col));
+        else
+            board.getLegalMoves(row, col, legalFromSelected);
+        requestFrame();
+    }
+
+    // What a pawn dropped on the last rank becomes: a queen, unless N, B or
+    // R is held
+    static Piece promotionChoice() {
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::N)) return W_KNIGHT;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::B)) return W_BISHOP;
+        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::R)) return W_ROOK;
+        return W_QUEEN;
     }
 
     void onMouseRelease(int mx, int my) {
         int col = renderer.xToCol(static_cast<float>(mx));
         int row = renderer.yToRow(static_cast<float>(my));
 
-        for (auto& m : legalFromSelected) {
-            if (m.toRow == row && m.toCol == col) {
-                if (undoHistory.size() >= 2)
-                    undoHistory.erase(undoHistory.begin());
-                undoHistory.push_back(board);
-                board.makeMove(m);
+        Piece promotion = promotionChoice();
+        for (Move m : legalFromSelected) {
+            if (m.toRow() == row && m.toCol() == col
+                && (m.promotion() == EMPTY || m.promotion() == promotion)) {
+                timeline.play(m);
                 break;
             }
         }
@@ -806,42 +314,28 @@ private:
         dragging = false;
         selRow = selCol = -1;
         legalFromSelected.clear();
+        requestFrame();
     }
 
     void render() {
+        PROFILE_SCOPE("Game::render");
         window.clear();
 
-        renderer.drawBoard(window);
-
-        if (viewMode == VIEW_ATTACK)
-            renderer.drawAttackHeatMap(window, board);
-        else if (viewMode == VIEW_DEFENDER)
-            renderer.drawDefenderMap(window, board);
-
-        if (selRow >= 0)
-            renderer.drawHighlight(window, selRow, selCol,
-                                   sf::Color(255, 255, 0, 100));
+        const PositionAnalysis* a = currentAnalysis();
+        shownAnalysis = a;
+        renderer.drawScene(window, board, a, viewMode, selRow, selCol, legalFromSelected,
+                           dragging, dragX, dragY);
 
-        if (!board.gameOver && board.isInCheck(board.sideToMove)) {
-            auto [kr, kc] = board.findKing(board.sideToMove);
-            renderer.drawHighlight(window, kr, kc,
-                                   sf::Color(255, 0, 0, 120));
-        }
-
-        for (auto& m : legalFromSelected)
-            renderer.drawLegalDot(window, m.toRow, m.toCol, board);
-
-        renderer.drawPieces(window, board,
-                            dragging ? selRow : -1,
-                            dragging ? selCol : -1);
-
-        if (dragging)
-            renderer.drawPiece(window, board.squares[selRow][selCol],
-                               dragX, dragY);
-
-        renderer.drawStatusBar(window, board, viewMode);
+        renderer.drawStatusBar(window, board, a, viewMode, timeline.ply(), timeline.length(),
+                               showStats ? &stats : nullptr);
+#ifdef CHESS_PROFILE
+        if (showProfile) renderer.drawProfileOverlay(window, Profiler::instance().lastFrame());
+#endif
 
         window.display();
+        dirty = false;
+        stats.rendered++;
+        sinceLastFrame.restart();
     }
 };
 
@@ -849,12 +343,51 @@ private:
 // main
 // ============================================================================
 
-int main() {
+// chess [--openings table.heat] [--startup-time]
+//
+// --startup-time shows the first frame, prints how long each startup step
+// took and exits, for measuring cold starts.
+int main(int argc, char** argv) {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+    std::string openingsPath;
+    bool startupTime = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--openings" && i + 1 < argc) openingsPath = argv[++i];
+        else if (arg == "--startup-time") startupTime = true;
+        else {
+            std::cerr << "usage: chess [--openings table.heat] [--startup-time]" << std::endl;
+            return 1;
+        }
+    }
+
     Game game;
+    Clock::time_point windowReady = Clock::now();
     if (!game.init()) {
         std::cerr << "Failed to initialize. Run from project root." << std::endl;
         return 1;
     }
+    Clock::time_point assetsReady = Clock::now();
+    if (!openingsPath.empty() && !game.loadOpenings(openingsPath)) return 1;
+    Clock::time_point openingsReady = Clock::now();
+
+    if (startupTime) {
+        game.renderFirstFrame();
+        Clock::time_point frameShown = Clock::now();
+        auto ms = [](Clock::time_point a, Clock::time_point b) {
+            return std::chrono::duration<double, std::milli>(b - a).count();
+        };
+        std::printf("window       %8.2f ms\n"
+                    "assets       %8.2f ms (%s)\n"
+                    "openings     %8.2f ms\n"
+                    "first frame  %8.2f ms\n"
+                    "total        %8.2f ms\n",
+                    ms(start, windowReady), ms(windowReady, assetsReady), Renderer::ASSET_SOURCE,
+                    ms(assetsReady, openingsReady), ms(openingsReady, frameShown),
+                    ms(start, frameShown));
+        return 0;
+    }
     game.run();
     return 0;
 }
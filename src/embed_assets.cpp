@@ -0,0 +1,119 @@
+#include "board_style.hpp"
+
+#include <SFML/Graphics/Image.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// embed_assets — generate the header that chess-embedded is built with
+//
+//   embed_assets [--font font.ttf] out.hpp
+//
+// The piece images are decoded here, at build time, and packed into the
+// atlas the Renderer would otherwise build at startup (layout as in
+// board_style.hpp), so the embedded game neither opens nor decodes a PNG.
+// The font file, if given, is embedded as is: SFML reads fonts from memory
+// without copying them. Run from the project root so the piece images are
+// found.
+// ============================================================================
+
+// Bytes as a comma-separated initializer, wrapped at a fixed width
+void writeBytes(std::ostream& out, const uint8_t* data, size_t size) {
+    int column = 0;
+    for (size_t i = 0; i < size; i++) {
+        char text[8];
+        int length = std::snprintf(text, sizeof(text), "%u,", data[i]);
+        if (column + length > 100) {
+            out << '\n';
+            column = 0;
+        }
+        out.write(text, length);
+        column += length;
+    }
+    if (size == 0) out << '0'; // an array can't be empty
+    out << '\n';
+}
+
+int main(int argc, char** argv) {
+    std::string fontPath;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--font" && i + 1 < argc) fontPath = argv[++i];
+        else positional.push_back(arg);
+    }
+    if (positional.size() != 1) {
+        std::cerr << "usage: embed_assets [--font font.ttf] out.hpp" << std::endl;
+        return 1;
+    }
+    const std::string& outPath = positional[0];
+
+    sf::Image images[13];
+    unsigned cell = 0;
+    for (auto& info : PIECE_IMAGE_FILES) {
+        if (!images[info.piece].loadFromFile(info.path)) {
+            std::cerr << "Failed to load " << info.path << std::endl;
+            return 1;
+        }
+        auto sz = images[info.piece].getSize();
+        cell = std::max({cell, sz.x, sz.y});
+    }
+
+    unsigned width = cell * PIECE_ATLAS_COLUMNS, height = cell * PIECE_ATLAS_ROWS;
+    std::vector<uint8_t> atlas(size_t(width) * height * 4, 0);
+    for (auto& info : PIECE_IMAGE_FILES) {
+        const sf::Image& image = images[info.piece];
+        unsigned x0 = atlasColumn(info.piece) * cell, y0 = atlasRow(info.piece) * cell;
+        for (unsigned y = 0; y < image.getSize().y; y++)
+            std::memcpy(&atlas[(size_t(y0 + y) * width + x0) * 4],
+                        image.getPixelsPtr() + size_t(y) * image.getSize().x * 4,
+                        size_t(image.getSize().x) * 4);
+    }
+
+    std::vector<uint8_t> font;
+    if (!fontPath.empty()) {
+        std::ifstream in(fontPath, std::ios::binary);
+        if (in) font.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        if (font.empty()) {
+            std::cerr << "Failed to read " << fontPath << std::endl;
+            return 1;
+        }
+    }
+
+    std::ofstream out(outPath, std::ios::binary);
+    out << "// Generated by embed_assets; do not edit.\n"
+        << "#pragma once\n\n"
+        << "#include <cstddef>\n"
+        << "#include <cstdint>\n\n"
+        << "// The piece atlas, RGBA, laid out as in board_style.hpp\n"
+        << "constexpr unsigned EMBEDDED_ATLAS_CELL = " << cell << ";\n"
+        << "constexpr unsigned EMBEDDED_ATLAS_WIDTH = " << width << ";\n"
+        << "constexpr unsigned EMBEDDED_ATLAS_HEIGHT = " << height << ";\n\n"
+        << "// Width and height of each piece's image within its cell, indexed by Piece\n"
+        << "constexpr unsigned EMBEDDED_PIECE_SIZE[13][2] = {\n";
+    for (int p = EMPTY; p <= B_QUEEN; p++)
+        out << "    {" << images[p].getSize().x << ", " << images[p].getSize().y << "},\n";
+    out << "};\n\n"
+        << "inline const uint8_t EMBEDDED_ATLAS_RGBA[] = {\n";
+    writeBytes(out, atlas.data(), atlas.size());
+    out << "};\n\n"
+        << "// Status bar font; EMBEDDED_FONT_SIZE is 0 if none was embedded\n"
+        << "constexpr size_t EMBEDDED_FONT_SIZE = " << font.size() << ";\n"
+        << "inline const uint8_t EMBEDDED_FONT[] = {\n";
+    writeBytes(out, font.data(), font.size());
+    out << "};\n";
+
+    if (!out.flush()) {
+        std::cerr << "Failed to write " << outPath << std::endl;
+        return 1;
+    }
+    std::cerr << width << "x" << height << " atlas, " << font.size() << " byte font" << std::endl;
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include "board.hpp"
+#include "heatmap_cache.hpp"
+#include "heatmap_file.hpp"
+#include "work_stealing.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ============================================================================
+// epdheat — convert EPD/FEN position lists into binary heat-map files
+//
+//   epdheat [--threads N] [--cache-mb M] positions.epd out.heat
+//                                                  one record per position
+//   epdheat --dump file.heat [first [count]]       print records as text
+//
+// Blank lines and lines starting with '#' are skipped. Lines that don't
+// parse are reported and left out of the output. With --cache-mb, heat maps
+// go through a HeatMapCache of that size shared by all threads, so a
+// position listed many times is computed about once; its hit and miss
+// counts are printed at the end to help size it.
+// ============================================================================
+
+// Positions converted in parallel before being written out in input order
+const size_t CHUNK_LINES = 1 << 16;
+
+void splitLines(std::string_view text, std::vector<std::string_view>& lines) {
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t eol = text.find('\n', pos);
+        if (eol == std::string_view::npos) eol = text.size();
+        lines.push_back(text.substr(pos, eol - pos));
+        pos = eol + 1;
+    }
+}
+
+int convert(const std::string& inPath, const std::string& outPath, int threads,
+            size_t cacheMegabytes) {
+    MappedFile input;
+    if (!input.open(inPath)) {
+        std::cerr << "Failed to read " << inPath << std::endl;
+        return 1;
+    }
+    HeatMapWriter writer;
+    if (!writer.open(outPath)) {
+        std::cerr << "Failed to write " << outPath << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<HeatMapCache> cache;
+    if (cacheMegabytes) cache.reset(new HeatMapCache(cacheMegabytes));
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::string_view> lines;
+    splitLines(input.data(), lines);
+
+    std::vector<HeatMapRecord> records;
+    std::vector<uint8_t> status; // 0 skipped, 1 converted, 2 invalid
+    uint64_t invalid = 0;
+
+    for (size_t first = 0; first < lines.size(); first += CHUNK_LINES) {
+        size_t n = std::min(CHUNK_LINES, lines.size() - first);
+        records.resize(n);
+        status.assign(n, 0);
+
+        parallelFor(n, threads, [&](size_t i, int) {
+            std::string_view line = lines[first + i];
+            size_t start = line.find_first_not_of(" \t\r");
+            if (start == std::string_view::npos || line[start] == '#') return;
+
+            Board board;
+            if (!board.loadEPD(std::string(line.substr(start)))) {
+                status[i] = 2;
+                return;
+            }
+            records[i].key = board.key;
+            if (cache) cache->lookup(board, records[i].maps);
+            else computeHeatMaps(board, records[i].maps);
+            status[i] = 1;
+        });
+
+        for (size_t i = 0; i < n; i++) {
+            if (status[i] == 1) {
+                if (!writer.write(records[i].key, records[i].maps)) {
+                    std::cerr << "Failed to write " << outPath << std::endl;
+                    return 1;
+                }
+            } else if (status[i] == 2) {
+                if (invalid++ < 10)
+                    std::cerr << inPath << ":" << first + i + 1 << ": invalid position" << std::endl;
+            }
+        }
+    }
+
+    if (!writer.close()) {
+        std::cerr << "Failed to write " << outPath << std::endl;
+        return 1;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << writer.written() << " positions written, " << invalid << " invalid, "
+              << elapsed << " s" << std::endl;
+    if (cache)
+        std::cerr << "cache: " << cache->capacity() << " slots, " << cache->hits() << " hits, "
+                  << cache->misses() << " misses" << std::endl;
+    return 0;
+}
+
+int dump(const std::string& path, size_t first, size_t count) {
+    HeatMapFile file;
+    if (!file.open(path)) {
+        std::cerr << "Not a readable heat-map file: " << path << std::endl;
+        return 1;
+    }
+
+    const char* layers[4] = {"attack white", "attack black", "defense white", "defense black"};
+    size_t last = (first < file.size()) ? first + std::min(count, file.size() - first) : first;
+    for (size_t i = first; i < last; i++) {
+        const HeatMapRecord& record = file[i];
+        std::cout << "#" << i << " key " << std::hex << std::setw(16) << std::setfill('0')
+                  << record.key << std::dec << std::setfill(' ') << "\n";
+        const uint8_t* grids[4] = {record.maps.attack[WHITE], record.maps.attack[BLACK],
+                                   record.maps.defense[WHITE], record.maps.defense[BLACK]};
+        for (int layer = 0; layer < 4; layer++) {
+            std::cout << "  " << std::left << std::setw(14) << layers[layer] << std::right;
+            for (int sq = 0; sq < 64; sq++)
+                std::cout << (sq ? " " : "") << static_cast<int>(grids[layer][sq]);
+            std::cout << "\n";
+        }
+    }
+    std::cerr << file.size() << " records" << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int threads = defaultThreadCount();
+    bool dumpMode = false;
+    size_t cacheMegabytes = 0;
+    std::vector<std::string> positional;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--cache-mb" && i + 1 < argc)
+            cacheMegabytes = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+        else if (arg == "--dump") dumpMode = true;
+        else positional.push_back(arg);
+    }
+
+    if (dumpMode && !positional.empty()) {
+        size_t first = positional.size() > 1 ? std::strtoull(positional[1].c_str(), nullptr, 10) : 0;
+        size_t count = positional.size() > 2 ? std::strtoull(positional[2].c_str(), nullptr, 10)
+                                             : SIZE_MAX;
+        return dump(positional[0], first, count);
+    }
+    if (!dumpMode && positional.size() == 2)
+        return convert(positional[0], positional[1], threads, cacheMegabytes);
+
+    std::cerr << "usage: epdheat [--threads N] [--cache-mb M] positions.epd out.heat\n"
+              << "       epdheat --dump file.heat [first [count]]" << std::endl;
+    return 1;
+}
@@ -0,0 +1,283 @@
+#include "board.hpp"
+#include "board_raster.hpp"
+#include "mapped_file.hpp"
+#include "pgn.hpp"
+#include "work_stealing.hpp"
+
+#include <SFML/Graphics/Image.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// heatexport — render positions to PNG without a window
+//
+//   heatexport [options] positions.epd outdir    one image per position
+//   heatexport [options] games.pgn outdir        one image per game
+//
+//   --view normal|attack|defender   overlay to draw (default attack)
+//   --size PX                       board edge in pixels (default 256)
+//   --every-ply                     PGN: one image per position, not per game
+//   --threads N                     worker threads (default: all cores)
+//
+// Images are rasterized on the CPU by BoardRasterizer, so there is no
+// window or GL context; SFML is only used to decode the piece images and
+// encode PNGs. Rasterizer threads hand finished pixel buffers to encoder
+// threads through a queue, and encoders return them to a fixed pool, so
+// PNG encoding overlaps rasterization and memory use stays bounded.
+//
+// EPD lines are named by line number (000042.png), games by game number
+// (g000007.png) and, with --every-ply, by game and ply (g000007-p012.png,
+// p000 being the starting position). Run from the project root so the piece
+// images are found.
+// ============================================================================
+
+struct ExportJob {
+    PackedPosition position;
+    uint32_t number;  // EPD line or game, counting from 1
+    int16_t ply;      // -1 unless exporting every ply
+    bool fromGame;
+    bool repetition;  // drawn by threefold repetition, which needs the game's history
+};
+
+// Pixel buffers travel between the two thread groups through two of these:
+// one holding finished images, one holding free buffers
+class BufferQueue {
+public:
+    struct Item {
+        size_t job = 0;
+        std::vector<uint8_t> rgba;
+    };
+
+    void push(Item&& item) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            items.push_back(std::move(item));
+        }
+        notEmpty.notify_one();
+    }
+
+    // Returns false once the queue is closed and drained
+    bool pop(Item& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [&] { return !items.empty() || closed; });
+        if (items.empty()) return false;
+        item = std::move(items.front());
+        items.pop_front();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notEmpty.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::deque<Item> items;
+    bool closed = false;
+};
+
+bool loadPieceImages(BoardRasterizer& raster) {
+    for (auto& info : PIECE_IMAGE_FILES) {
+        sf::Image image;
+        if (!image.loadFromFile(info.path)) {
+            std::cerr << "Failed to load " << info.path << std::endl;
+            return false;
+        }
+        raster.setPieceImage(info.piece, image.getPixelsPtr(), image.getSize().x,
+                             image.getSize().y);
+    }
+    return true;
+}
+
+void splitLines(std::string_view text, std::vector<std::string_view>& lines) {
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t eol = text.find('\n', pos);
+        if (eol == std::string_view::npos) eol = text.size();
+        lines.push_back(text.substr(pos, eol - pos));
+        pos = eol + 1;
+    }
+}
+
+// Lines that don't parse are reported and skipped
+void collectEpd(std::string_view text, const std::string& path, std::vector<ExportJob>& jobs) {
+    std::vector<std::string_view> lines;
+    splitLines(text, lines);
+    jobs.resize(lines.size());
+    std::vector<uint8_t> status(lines.size(), 0); // 0 skipped, 1 loaded, 2 invalid
+
+    parallelFor(lines.size(), defaultThreadCount(), [&](size_t i, int) {
+        std::string_view line = lines[i];
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string_view::npos || line[start] == '#') return;
+        Board board;
+        if (!board.loadEPD(std::string(line.substr(start)))) {
+            status[i] = 2;
+            return;
+        }
+        jobs[i] = {board.pack(), static_cast<uint32_t>(i + 1), -1, false, false};
+        status[i] = 1;
+    });
+
+    size_t kept = 0, invalid = 0;
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (status[i] == 1) jobs[kept++] = jobs[i];
+        else if (status[i] == 2 && invalid++ < 10)
+            std::cerr << path << ":" << i + 1 << ": invalid position" << std::endl;
+    }
+    jobs.resize(kept);
+}
+
+// A game's positions up to the first move that doesn't parse
+void collectPgn(std::string_view text, bool everyPly, std::vector<ExportJob>& jobs) {
+    PgnScanner scanner(text);
+    std::string_view game;
+    uint32_t number = 0;
+    while (scanner.nextGame(game)) {
+        number++;
+        Board board;
+        std::string_view fen = pgnTag(game, "FEN");
+        if (!fen.empty() && !board.loadFEN(std::string(fen))) continue;
+
+        SanTokenizer tokens(game);
+        std::string_view san;
+        UndoInfo undo;
+        KeyHistory history;
+        auto repeated = [&] { return history.repetitions(board.key, board.halfmoveClock) >= 2; };
+        for (int ply = 0; ; ply++) {
+            if (everyPly)
+                jobs.push_back({board.pack(), number, static_cast<int16_t>(ply), true, repeated()});
+            Move m;
+            if (!tokens.next(san) || !sanToMove(board, san, m)) break;
+            history.push(board.key);
+            board.makeMove(m, undo);
+        }
+        if (!everyPly) jobs.push_back({board.pack(), number, -1, true, repeated()});
+    }
+}
+
+std::string imageName(const ExportJob& job) {
+    char name[32];
+    if (!job.fromGame) std::snprintf(name, sizeof(name), "%06u.png", job.number);
+    else if (job.ply < 0) std::snprintf(name, sizeof(name), "g%06u.png", job.number);
+    else std::snprintf(name, sizeof(name), "g%06u-p%03d.png", job.number, job.ply);
+    return name;
+}
+
+int exportImages(const std::vector<ExportJob>& jobs, const BoardRasterizer& raster,
+                 ViewMode viewMode, const std::filesystem::path& outDir, int threads) {
+    // Encoding a PNG costs several times more than drawing it, so most
+    // threads encode
+    int rasterThreads = std::max(1, threads / 4);
+    int encodeThreads = std::max(1, threads - rasterThreads);
+
+    BufferQueue freeBuffers, finished;
+    for (int i = 0; i < (rasterThreads + encodeThreads) * 2; i++)
+        freeBuffers.push({0, std::vector<uint8_t>(raster.bufferBytes())});
+
+    std::atomic<uint64_t> failed{0};
+    std::vector<std::thread> encoders;
+    for (int t = 0; t < encodeThreads; t++)
+        encoders.emplace_back([&]() {
+            BufferQueue::Item item;
+            while (finished.pop(item)) {
+                unsigned size = static_cast<unsigned>(raster.imageSize());
+                sf::Image image({size, size}, item.rgba.data());
+                std::filesystem::path path = outDir / imageName(jobs[item.job]);
+                if (!image.saveToFile(path) && failed++ < 10)
+                    std::cerr << "Failed to write " << path.string() << std::endl;
+                freeBuffers.push(std::move(item));
+            }
+        });
+
+    parallelFor(jobs.size(), rasterThreads, [&](size_t i, int) {
+        BufferQueue::Item item;
+        freeBuffers.pop(item);
+        Board board;
+        board.unpack(jobs[i].position);
+        board.updateGameOver(); // no check highlight on a finished game
+        if (jobs[i].repetition) board.gameOver = true;
+        raster.render(board, viewMode, item.rgba.data());
+        item.job = i;
+        finished.push(std::move(item));
+    });
+
+    finished.close();
+    for (auto& th : encoders) th.join();
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    int threads = defaultThreadCount();
+    int size = 256;
+    bool everyPly = false;
+    ViewMode viewMode = VIEW_ATTACK;
+    std::vector<std::string> positional;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--size" && i + 1 < argc) size = std::atoi(argv[++i]);
+        else if (arg == "--every-ply") everyPly = true;
+        else if (arg == "--view" && i + 1 < argc) {
+            std::string view = argv[++i];
+            if (view == "normal") viewMode = VIEW_NORMAL;
+            else if (view == "attack") viewMode = VIEW_ATTACK;
+            else if (view == "defender") viewMode = VIEW_DEFENDER;
+            else {
+                std::cerr << "Unknown view: " << view << std::endl;
+                return 1;
+            }
+        } else positional.push_back(arg);
+    }
+    if (positional.size() != 2 || size < 8) {
+        std::cerr << "usage: heatexport [--view normal|attack|defender] [--size PX] [--every-ply]\n"
+                  << "                  [--threads N] positions.epd|games.pgn outdir" << std::endl;
+        return 1;
+    }
+    const std::string& inPath = positional[0];
+    const std::filesystem::path outDir = positional[1];
+
+    BoardRasterizer raster(size / 8);
+    if (!loadPieceImages(raster)) return 1;
+
+    MappedFile input;
+    if (!input.open(inPath)) {
+        std::cerr << "Failed to read " << inPath << std::endl;
+        return 1;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(outDir, error);
+    if (error) {
+        std::cerr << "Failed to create " << outDir.string() << ": " << error.message() << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ExportJob> jobs;
+    bool pgn = inPath.size() >= 4 && inPath.compare(inPath.size() - 4, 4, ".pgn") == 0;
+    if (pgn) collectPgn(input.data(), everyPly, jobs);
+    else collectEpd(input.data(), inPath, jobs);
+
+    int status = exportImages(jobs, raster, viewMode, outDir, threads);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << jobs.size() << " images, " << elapsed << " s ("
+              << static_cast<uint64_t>(jobs.size() / std::max(elapsed, 1e-9)) << "/s)" << std::endl;
+    return status;
+}
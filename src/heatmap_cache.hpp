@@ -0,0 +1,137 @@
+#pragma once
+
+#include "board.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+// ============================================================================
+// Packed heat maps — attack and defense counts for both sides, one byte per
+// square (no square is ever reached by more than 255 pieces)
+// ============================================================================
+
+struct PackedHeatMaps {
+    uint8_t attack[2][64];  // indexed by Color, then square (row * 8 + col)
+    uint8_t defense[2][64];
+};
+
+inline void computeHeatMaps(const Board& board, PackedHeatMaps& out) {
+    PROFILE_SCOPE("computeHeatMaps");
+    std::array<std::array<int,8>,8> white, black;
+    board.getAttackCounts(white, black);
+    for (int sq = 0; sq < 64; sq++) {
+        out.attack[WHITE][sq] = static_cast<uint8_t>(white[sq / 8][sq % 8]);
+        out.attack[BLACK][sq] = static_cast<uint8_t>(black[sq / 8][sq % 8]);
+    }
+    board.getDefenseCounts(white, black);
+    for (int sq = 0; sq < 64; sq++) {
+        out.defense[WHITE][sq] = static_cast<uint8_t>(white[sq / 8][sq % 8]);
+        out.defense[BLACK][sq] = static_cast<uint8_t>(black[sq / 8][sq % 8]);
+    }
+}
+
+// Expand one packed layer (e.g. maps.attack[WHITE]) back into a board grid
+inline void unpackGrid(const uint8_t counts[64], std::array<std::array<int,8>,8>& grid) {
+    for (int sq = 0; sq < 64; sq++)
+        grid[sq / 8][sq % 8] = counts[sq];
+}
+
+// ============================================================================
+// HeatMapCache — fixed-size table from Zobrist key to packed heat maps,
+// shared by any number of threads without locks.
+//
+// Each slot is guarded by a sequence counter (a seqlock). A writer claims a
+// slot by bumping the counter to odd with a CAS and simply skips the store if
+// another writer holds it. Readers never wait: a read that overlaps a write
+// is reported as a miss. The payload is stored as relaxed atomic words so
+// racing readers stay well-defined.
+// ============================================================================
+
+class HeatMapCache {
+public:
+    // The slot count is the largest power of two that fits in the budget
+    explicit HeatMapCache(size_t megabytes) {
+        size_t budget = megabytes * 1024 * 1024;
+        slotCount = 1;
+        while (slotCount * 2 * sizeof(Slot) <= budget) slotCount *= 2;
+        slots.reset(new Slot[slotCount]());
+    }
+
+    bool probe(uint64_t key, PackedHeatMaps& out) const {
+        const Slot& slot = slots[key & (slotCount - 1)];
+        uint64_t seq = slot.sequence.load(std::memory_order_acquire);
+        if ((seq & 1) || slot.key.load(std::memory_order_relaxed) != key) {
+            stats.misses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        uint64_t words[WORDS];
+        for (size_t i = 0; i < WORDS; i++)
+            words[i] = slot.data[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != seq) {
+            stats.misses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        std::memcpy(&out, words, sizeof(out));
+        stats.hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void store(uint64_t key, const PackedHeatMaps& maps) {
+        Slot& slot = slots[key & (slotCount - 1)];
+        uint64_t seq = slot.sequence.load(std::memory_order_relaxed);
+        if ((seq & 1) || !slot.sequence.compare_exchange_strong(
+                seq, seq + 1, std::memory_order_relaxed))
+            return; // another writer owns the slot; dropping this store is fine
+        std::atomic_thread_fence(std::memory_order_release);
+
+        uint64_t words[WORDS];
+        std::memcpy(words, &maps, sizeof(maps));
+        slot.key.store(key, std::memory_order_relaxed);
+        for (size_t i = 0; i < WORDS; i++)
+            slot.data[i].store(words[i], std::memory_order_relaxed);
+        slot.sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // Cached heat maps for the board, computing and storing them on a miss
+    void lookup(const Board& board, PackedHeatMaps& out) {
+        if (probe(board.key, out)) return;
+        computeHeatMaps(board, out);
+        store(board.key, out);
+    }
+
+    uint64_t hits() const { return stats.hits.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return stats.misses.load(std::memory_order_relaxed); }
+    size_t capacity() const { return slotCount; }
+
+    void resetStats() {
+        stats.hits.store(0, std::memory_order_relaxed);
+        stats.misses.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr size_t WORDS = sizeof(PackedHeatMaps) / sizeof(uint64_t);
+    static_assert(sizeof(PackedHeatMaps) % sizeof(uint64_t) == 0,
+                  "PackedHeatMaps must be a whole number of words");
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> sequence{0}; // odd while a writer is filling the slot
+        std::atomic<uint64_t> key{0};
+        std::atomic<uint64_t> data[WORDS]{};
+    };
+
+    // Counters live on their own cache lines so they don't share with slots
+    struct Stats {
+        alignas(64) std::atomic<uint64_t> hits{0};
+        alignas(64) std::atomic<uint64_t> misses{0};
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t slotCount;
+    mutable Stats stats;
+};
@@ -0,0 +1,335 @@
+#pragma once
+
+#include "board.hpp"
+#include "heatmap_cache.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+// ============================================================================
+// Heat-map colouring — turns packed heat maps into RGBA pixels, one pixel per
+// square (a1 first), four bytes each in R, G, B, A order as sf::Image and
+// sf::Texture expect. Squares with nothing to show are fully transparent.
+//
+// Attack map:   white ahead -> blue, black ahead -> red,
+//               alpha = min(|white - black| * 60, 230)
+// Defender map: occupied squares only, in the piece's colour,
+//               alpha = min(defenders * 75, 230); undefended pieces white
+//
+// Each kernel exists as scalar code and as SSE4.1 and AVX2 versions; the
+// widest one the CPU supports is picked at runtime. Build with
+// -DCHESS_NO_SIMD to compile the scalar code only.
+// ============================================================================
+
+const uint8_t HEAT_WHITE_RGB[3] = {70, 130, 230};
+const uint8_t HEAT_BLACK_RGB[3] = {230, 70, 70};
+const uint8_t HEAT_UNDEFENDED_RGBA[4] = {255, 255, 255, 140};
+
+// Both alpha ramps saturate at 230 from a count of 4, so they fit in a
+// five-entry table indexed by min(count, 4)
+const uint8_t ATTACK_ALPHA[5] = {0, 60, 120, 180, 230};
+const uint8_t DEFENSE_ALPHA[5] = {0, 75, 150, 225, 230};
+
+// ---------------------------------------------------------------------------
+// Scalar reference
+// ---------------------------------------------------------------------------
+
+inline void attackGridScalar(const uint8_t* white, const uint8_t* black, uint8_t* rgba) {
+    for (int sq = 0; sq < 64; sq++, rgba += 4) {
+        int diff = white[sq] - black[sq];
+        if (diff == 0) {
+            rgba[0] = rgba[1] = rgba[2] = rgba[3] = 0;
+            continue;
+        }
+        const uint8_t* rgb = (diff > 0) ? HEAT_WHITE_RGB : HEAT_BLACK_RGB;
+        rgba[0] = rgb[0];
+        rgba[1] = rgb[1];
+        rgba[2] = rgb[2];
+        rgba[3] = static_cast<uint8_t>(std::min(std::abs(diff) * 60, 230));
+    }
+}
+
+inline void defenderGridScalar(const uint8_t* white, const uint8_t* black,
+                               Bitboard whiteOcc, Bitboard blackOcc, uint8_t* rgba) {
+    for (int sq = 0; sq < 64; sq++, rgba += 4) {
+        bool isWhitePiece = whiteOcc & squareBit(sq);
+        if (!isWhitePiece && !(blackOcc & squareBit(sq))) {
+            rgba[0] = rgba[1] = rgba[2] = rgba[3] = 0;
+            continue;
+        }
+        int defenders = isWhitePiece ? white[sq] : black[sq];
+        if (defenders == 0) {
+            std::copy(HEAT_UNDEFENDED_RGBA, HEAT_UNDEFENDED_RGBA + 4, rgba);
+            continue;
+        }
+        const uint8_t* rgb = isWhitePiece ? HEAT_WHITE_RGB : HEAT_BLACK_RGB;
+        rgba[0] = rgb[0];
+        rgba[1] = rgb[1];
+        rgba[2] = rgb[2];
+        rgba[3] = static_cast<uint8_t>(std::min(defenders * 75, 230));
+    }
+}
+
+inline void attackBatchScalar(const PackedHeatMaps* maps, size_t count, uint8_t* rgba) {
+    for (size_t i = 0; i < count; i++, rgba += 256)
+        attackGridScalar(maps[i].attack[WHITE], maps[i].attack[BLACK], rgba);
+}
+
+inline void defenderBatchScalar(const PackedHeatMaps* maps, const Bitboard* occupancy,
+                                size_t count, uint8_t* rgba) {
+    for (size_t i = 0; i < count; i++, rgba += 256)
+        defenderGridScalar(maps[i].defense[WHITE], maps[i].defense[BLACK],
+                           occupancy[2 * i + WHITE], occupancy[2 * i + BLACK], rgba);
+}
+
+// ---------------------------------------------------------------------------
+// SSE4.1 and AVX2 — 16 or 32 squares per step. Counts are unsigned bytes, so
+// |white - black| is the OR of the two saturating differences, and the alpha
+// ramps are a byte shuffle into the tables above.
+// ---------------------------------------------------------------------------
+
+#if !defined(CHESS_NO_SIMD) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CHESS_SIMD_AVAILABLE 1
+#include <immintrin.h>
+
+#define CHESS_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define CHESS_TARGET_AVX2 __attribute__((target("avx2")))
+
+// One 0x00/0xFF byte per square for the 16 squares starting at `first`
+CHESS_TARGET_SSE41 inline __m128i squareMask16(Bitboard bb, int first) {
+    __m128i bits = _mm_set1_epi16(static_cast<short>(bb >> first));
+    __m128i spread = _mm_shuffle_epi8(bits, _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0,
+                                                          1, 1, 1, 1, 1, 1, 1, 1));
+    __m128i select = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128,
+                                   1, 2, 4, 8, 16, 32, 64, -128);
+    return _mm_cmpeq_epi8(_mm_and_si128(spread, select), select);
+}
+
+// Interleave byte planes into 16 RGBA pixels
+CHESS_TARGET_SSE41 inline void storeRgba16(__m128i r, __m128i g, __m128i b, __m128i a,
+                                           uint8_t* out) {
+    __m128i rgLo = _mm_unpacklo_epi8(r, g), rgHi = _mm_unpackhi_epi8(r, g);
+    __m128i baLo = _mm_unpacklo_epi8(b, a), baHi = _mm_unpackhi_epi8(b, a);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out),      _mm_unpacklo_epi16(rgLo, baLo));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi16(rgLo, baLo));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 32), _mm_unpacklo_epi16(rgHi, baHi));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 48), _mm_unpackhi_epi16(rgHi, baHi));
+}
+
+CHESS_TARGET_SSE41 inline void attackGridSse41(const uint8_t* white, const uint8_t* black,
+                                               uint8_t* rgba) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i four = _mm_set1_epi8(4);
+    const __m128i alphaTable = _mm_setr_epi8(0, 60, 120, static_cast<char>(180),
+                                             static_cast<char>(230), 0, 0, 0,
+                                             0, 0, 0, 0, 0, 0, 0, 0);
+    for (int sq = 0; sq < 64; sq += 16) {
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(white + sq));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(black + sq));
+        __m128i whiteAhead = _mm_subs_epu8(w, b);
+        __m128i absDiff = _mm_or_si128(whiteAhead, _mm_subs_epu8(b, w));
+        __m128i shown = _mm_xor_si128(_mm_cmpeq_epi8(absDiff, zero), _mm_set1_epi8(-1));
+        __m128i blue = _mm_xor_si128(_mm_cmpeq_epi8(whiteAhead, zero), _mm_set1_epi8(-1));
+
+        __m128i r = _mm_blendv_epi8(_mm_set1_epi8(HEAT_BLACK_RGB[0]), _mm_set1_epi8(HEAT_WHITE_RGB[0]), blue);
+        __m128i g = _mm_blendv_epi8(_mm_set1_epi8(HEAT_BLACK_RGB[1]), _mm_set1_epi8(HEAT_WHITE_RGB[1]), blue);
+        __m128i bl = _mm_blendv_epi8(_mm_set1_epi8(HEAT_BLACK_RGB[2]), _mm_set1_epi8(HEAT_WHITE_RGB[2]), blue);
+        __m128i a = _mm_shuffle_epi8(alphaTable, _mm_min_epu8(absDiff, four));
+        storeRgba16(_mm_and_si128(r, shown), _mm_and_si128(g, shown),
+                    _mm_and_si128(bl, shown), a, rgba + sq * 4);
+    }
+}
+
+CHESS_TARGET_SSE41 inline void defenderGridSse41(const uint8_t* white, const uint8_t* black,
+                                                 Bitboard whiteOcc, Bitboard blackOcc,
+                                                 uint8_t* rgba) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i four = _mm_set1_epi8(4);
+    const __m128i alphaTable = _mm_setr_epi8(0, 75, static_cast<char>(150), static_cast<char>(225),
+                                             static_cast<char>(230), 0, 0, 0,
+                                             0, 0, 0, 0, 0, 0, 0, 0);
+    for (int sq = 0; sq < 64; sq += 16) {
+        __m128i isWhite = squareMask16(whiteOcc, sq);
+        __m128i occupied = _mm_or_si128(isWhite, squareMask16(blackOcc, sq));
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(white + sq));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(black + sq));
+        __m128i defenders = _mm_blendv_epi8(b, w, isWhite);
+        __m128i undefended = _mm_cmpeq_epi8(defenders, zero);
+
+        __m128i r = _mm_blendv_epi8(_mm_set1_epi8(HEAT_BLACK_RGB[0]), _mm_set1_epi8(HEAT_WHITE_RGB[0]), isWhite);
+        __m128i g = _mm_blendv_epi8(_mm_set1_epi8(HEAT_BLACK_RGB[1]), _mm_set1_epi8(HEAT_WHITE_RGB[1]), isWhite);
+        __m128i bl = _mm_blendv_epi8(_mm_set1_epi8(HEAT_BLACK_RGB[2]), _mm_set1_epi8(HEAT_WHITE_RGB[2]), isWhite);
+        __m128i a = _mm_shuffle_epi8(alphaTable, _mm_min_epu8(defenders, four));
+
+        r = _mm_blendv_epi8(r, _mm_set1_epi8(static_cast<char>(HEAT_UNDEFENDED_RGBA[0])), undefended);
+        g = _mm_blendv_epi8(g, _mm_set1_epi8(static_cast<char>(HEAT_UNDEFENDED_RGBA[1])), undefended);
+        bl = _mm_blendv_epi8(bl, _mm_set1_epi8(static_cast<char>(HEAT_UNDEFENDED_RGBA[2])), undefended);
+        a = _mm_blendv_epi8(a, _mm_set1_epi8(static_cast<char>(HEAT_UNDEFENDED_RGBA[3])), undefended);
+        storeRgba16(_mm_and_si128(r, occupied), _mm_and_si128(g, occupied),
+                    _mm_and_si128(bl, occupied), _mm_and_si128(a, occupied), rgba + sq * 4);
+    }
+}
+
+CHESS_TARGET_SSE41 inline void attackBatchSse41(const PackedHeatMaps* maps, size_t count,
+                                                uint8_t* rgba) {
+    for (size_t i = 0; i < count; i++, rgba += 256)
+        attackGridSse41(maps[i].attack[WHITE], maps[i].attack[BLACK], rgba);
+}
+
+CHESS_TARGET_SSE41 inline void defenderBatchSse41(const PackedHeatMaps* maps,
+                                                  const Bitboard* occupancy, size_t count,
+                                                  uint8_t* rgba) {
+    for (size_t i = 0; i < count; i++, rgba += 256)
+        defenderGridSse41(maps[i].defense[WHITE], maps[i].defense[BLACK],
+                          occupancy[2 * i + WHITE], occupancy[2 * i + BLACK], rgba);
+}
+
+// AVX2 byte shuffles and unpacks stay within 128-bit lanes, so the lane
+// halves are paired up again before storing
+CHESS_TARGET_AVX2 inline __m256i squareMask32(Bitboard bb, int first) {
+    __m256i bits = _mm256_set1_epi32(static_cast<int>(bb >> first));
+    __m256i spread = _mm256_shuffle_epi8(bits, _mm256_setr_epi8(
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+        2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3));
+    __m256i select = _mm256_set1_epi64x(static_cast<long long>(0x8040201008040201ULL));
+    return _mm256_cmpeq_epi8(_mm256_and_si256(spread, select), select);
+}
+
+CHESS_TARGET_AVX2 inline void storeRgba32(__m256i r, __m256i g, __m256i b, __m256i a,
+                                          uint8_t* out) {
+    __m256i rgLo = _mm256_unpacklo_epi8(r, g), rgHi = _mm256_unpackhi_epi8(r, g);
+    __m256i baLo = _mm256_unpacklo_epi8(b, a), baHi = _mm256_unpackhi_epi8(b, a);
+    __m256i p0 = _mm256_unpacklo_epi16(rgLo, baLo); // squares 0-3  | 16-19
+    __m256i p1 = _mm256_unpackhi_epi16(rgLo, baLo); // squares 4-7  | 20-23
+    __m256i p2 = _mm256_unpacklo_epi16(rgHi, baHi); // squares 8-11 | 24-27
+    __m256i p3 = _mm256_unpackhi_epi16(rgHi, baHi); // squares 12-15 | 28-31
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out),      _mm256_permute2x128_si256(p0, p1, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), _mm256_permute2x128_si256(p2, p3, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 64), _mm256_permute2x128_si256(p0, p1, 0x31));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 96), _mm256_permute2x128_si256(p2, p3, 0x31));
+}
+
+CHESS_TARGET_AVX2 inline void attackGridAvx2(const uint8_t* white, const uint8_t* black,
+                                             uint8_t* rgba) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i four = _mm256_set1_epi8(4);
+    const __m256i alphaTable = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+        0, 60, 120, static_cast<char>(180), static_cast<char>(230), 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0));
+    for (int sq = 0; sq < 64; sq += 32) {
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(white + sq));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(black + sq));
+        __m256i whiteAhead = _mm256_subs_epu8(w, b);
+        __m256i absDiff = _mm256_or_si256(whiteAhead, _mm256_subs_epu8(b, w));
+        __m256i shown = _mm256_xor_si256(_mm256_cmpeq_epi8(absDiff, zero), _mm256_set1_epi8(-1));
+        __m256i blue = _mm256_xor_si256(_mm256_cmpeq_epi8(whiteAhead, zero), _mm256_set1_epi8(-1));
+
+        __m256i r = _mm256_blendv_epi8(_mm256_set1_epi8(HEAT_BLACK_RGB[0]), _mm256_set1_epi8(HEAT_WHITE_RGB[0]), blue);
+        __m256i g = _mm256_blendv_epi8(_mm256_set1_epi8(HEAT_BLACK_RGB[1]), _mm256_set1_epi8(HEAT_WHITE_RGB[1]), blue);
+        __m256i bl = _mm256_blendv_epi8(_mm256_set1_epi8(HEAT_BLACK_RGB[2]), _mm256_set1_epi8(HEAT_WHITE_RGB[2]), blue);
+        __m256i a = _mm256_shuffle_epi8(alphaTable, _mm256_min_epu8(absDiff, four));
+        storeRgba32(_mm256_and_si256(r, shown), _mm256_and_si256(g, shown),
+                    _mm256_and_si256(bl, shown), a, rgba + sq * 4);
+    }
+}
+
+CHESS_TARGET_AVX2 inline void defenderGridAvx2(const uint8_t* white, const uint8_t* black,
+                                               Bitboard whiteOcc, Bitboard blackOcc,
+                                               uint8_t* rgba) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i four = _mm256_set1_epi8(4);
+    const __m256i alphaTable = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+        0, 75, static_cast<char>(150), static_cast<char>(225), static_cast<char>(230), 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0));
+    for (int sq = 0; sq < 64; sq += 32) {
+        __m256i isWhite = squareMask32(whiteOcc, sq);
+        __m256i occupied = _mm256_or_si256(isWhite, squareMask32(blackOcc, sq));
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(white + sq));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(black + sq));
+        __m256i defenders = _mm256_blendv_epi8(b, w, isWhite);
+        __m256i undefended = _mm256_cmpeq_epi8(defenders, zero);
+
+        __m256i r = _mm256_blendv_epi8(_mm256_set1_epi8(HEAT_BLACK_RGB[0]), _mm256_set1_epi8(HEAT_WHITE_RGB[0]), isWhite);
+        __m256i g = _mm256_blendv_epi8(_mm256_set1_epi8(HEAT_BLACK_RGB[1]), _mm256_set1_epi8(HEAT_WHITE_RGB[1]), isWhite);
+        __m256i bl = _mm256_blendv_epi8(_mm256_set1_epi8(HEAT_BLACK_RGB[2]), _mm256_set1_epi8(HEAT_WHITE_RGB[2]), isWhite);
+        __m256i a = _mm256_shuffle_epi8(alphaTable, _mm256_min_epu8(defenders, four));
+
+        r = _mm256_blendv_epi8(r, _mm256_set1_epi8(static_cast<char>(HEAT_UNDEFENDED_RGBA[0])), undefended);
+        g = _mm256_blendv_epi8(g, _mm256_set1_epi8(static_cast<char>(HEAT_UNDEFENDED_RGBA[1])), undefended);
+        bl = _mm256_blendv_epi8(bl, _mm256_set1_epi8(static_cast<char>(HEAT_UNDEFENDED_RGBA[2])), undefended);
+        a = _mm256_blendv_epi8(a, _mm256_set1_epi8(static_cast<char>(HEAT_UNDEFENDED_RGBA[3])), undefended);
+        storeRgba32(_mm256_and_si256(r, occupied), _mm256_and_si256(g, occupied),
+                    _mm256_and_si256(bl, occupied), _mm256_and_si256(a, occupied), rgba + sq * 4);
+    }
+}
+
+CHESS_TARGET_AVX2 inline void attackBatchAvx2(const PackedHeatMaps* maps, size_t count,
+                                              uint8_t* rgba) {
+    for (size_t i = 0; i < count; i++, rgba += 256)
+        attackGridAvx2(maps[i].attack[WHITE], maps[i].attack[BLACK], rgba);
+}
+
+CHESS_TARGET_AVX2 inline void defenderBatchAvx2(const PackedHeatMaps* maps,
+                                                const Bitboard* occupancy, size_t count,
+                                                uint8_t* rgba) {
+    for (size_t i = 0; i < count; i++, rgba += 256)
+        defenderGridAvx2(maps[i].defense[WHITE], maps[i].defense[BLACK],
+                         occupancy[2 * i + WHITE], occupancy[2 * i + BLACK], rgba);
+}
+
+#else
+#define CHESS_SIMD_AVAILABLE 0
+#endif
+
+// ---------------------------------------------------------------------------
+// Runtime dispatch
+// ---------------------------------------------------------------------------
+
+enum SimdLevel { SIMD_SCALAR, SIMD_SSE41, SIMD_AVX2 };
+
+inline SimdLevel detectSimdLevel() {
+#if CHESS_SIMD_AVAILABLE
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse4.1")) return SIMD_SSE41;
+#endif
+    return SIMD_SCALAR;
+}
+
+// Batch kernels: maps[count] in, count * 256 bytes of RGBA out. The defender
+// kernel also takes each position's occupancy as {white, black} pairs,
+// i.e. occupancy[2 * i + WHITE] and occupancy[2 * i + BLACK].
+struct HeatColorKernels {
+    const char* name;
+    void (*attack)(const PackedHeatMaps* maps, size_t count, uint8_t* rgba);
+    void (*defender)(const PackedHeatMaps* maps, const Bitboard* occupancy, size_t count,
+                     uint8_t* rgba);
+};
+
+// Kernels for a given level, falling back to scalar where it isn't built
+inline HeatColorKernels heatColorKernelsFor(SimdLevel level) {
+#if CHESS_SIMD_AVAILABLE
+    if (level == SIMD_AVX2) return {"avx2", attackBatchAvx2, defenderBatchAvx2};
+    if (level == SIMD_SSE41) return {"sse4.1", attackBatchSse41, defenderBatchSse41};
+#endif
+    (void)level;
+    return {"scalar", attackBatchScalar, defenderBatchScalar};
+}
+
+// The fastest kernels this CPU runs, chosen on first use
+inline const HeatColorKernels& heatColorKernels() {
+    static const HeatColorKernels kernels = heatColorKernelsFor(detectSimdLevel());
+    return kernels;
+}
+
+// Single-board convenience wrappers
+inline void attackHeatToRgba(const PackedHeatMaps& maps, uint8_t rgba[256]) {
+    heatColorKernels().attack(&maps, 1, rgba);
+}
+
+inline void defenderHeatToRgba(const PackedHeatMaps& maps, Bitboard whiteOcc, Bitboard blackOcc,
+                               uint8_t rgba[256]) {
+    const Bitboard occupancy[2] = {whiteOcc, blackOcc};
+    heatColorKernels().defender(&maps, occupancy, 1, rgba);
+}
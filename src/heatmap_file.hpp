@@ -0,0 +1,176 @@
+#pragma once
+
+#include "heatmap_cache.hpp"
+#include "mapped_file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+// ============================================================================
+// Heat-map files — fixed-size binary records that can be mmapped and indexed
+// directly, with no parsing.
+//
+//   offset 0    HeatMapFileHeader (64 bytes)
+//   offset 64   HeatMapRecord[recordCount] (264 bytes each)
+//
+// A record is the position's Zobrist key followed by its PackedHeatMaps:
+// attack counts for white and black, then defense counts for white and
+// black, one byte per square (a1 = 0 ... h8 = 63). Integers are stored in
+// the writer's native byte order, little-endian on every supported target.
+//
+// Files with HEAT_FILE_SORTED in their flags hold strictly increasing keys
+// and can be searched by key in place (HeatMapFile::find).
+// ============================================================================
+
+struct HeatMapFileHeader {
+    char magic[8];         // HEAT_FILE_MAGIC
+    uint32_t version;      // HEAT_FILE_VERSION
+    uint32_t recordSize;   // sizeof(HeatMapRecord)
+    uint64_t recordCount;
+    uint32_t flags;        // HEAT_FILE_SORTED
+    uint8_t reserved[36];  // zero; pads the header to one cache line
+};
+
+struct HeatMapRecord {
+    uint64_t key;
+    PackedHeatMaps maps;
+};
+
+static_assert(sizeof(HeatMapFileHeader) == 64, "heat-map file header must be 64 bytes");
+static_assert(sizeof(HeatMapRecord) == 264, "heat-map records must be 264 bytes");
+
+const char HEAT_FILE_MAGIC[8] = {'C', 'H', 'M', 'H', 'E', 'A', 'T', '\0'};
+const uint32_t HEAT_FILE_VERSION = 1;
+const uint32_t HEAT_FILE_SORTED = 1; // records are in increasing key order
+
+// Appends records to a new file. The record count in the header is filled
+// in by close(), so a file that was never closed reads back as empty. With
+// HEAT_FILE_SORTED, write() fails unless keys arrive in increasing order.
+class HeatMapWriter {
+public:
+    ~HeatMapWriter() { close(); }
+
+    bool open(const std::string& path, uint32_t fileFlags = 0) {
+        out.open(path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        count = 0;
+        flags = fileFlags;
+        HeatMapFileHeader header = makeHeader();
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        return static_cast<bool>(out);
+    }
+
+    bool write(uint64_t key, const PackedHeatMaps& maps) {
+        if ((flags & HEAT_FILE_SORTED) && count > 0 && key <= lastKey) return false;
+        lastKey = key;
+        HeatMapRecord record;
+        record.key = key;
+        record.maps = maps;
+        out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        count++;
+        return static_cast<bool>(out);
+    }
+
+    bool close() {
+        if (!out.is_open()) return true;
+        HeatMapFileHeader header = makeHeader();
+        header.recordCount = count;
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        bool ok = static_cast<bool>(out);
+        out.close();
+        return ok;
+    }
+
+    uint64_t written() const { return count; }
+
+private:
+    HeatMapFileHeader makeHeader() const {
+        HeatMapFileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, HEAT_FILE_MAGIC, sizeof(header.magic));
+        header.version = HEAT_FILE_VERSION;
+        header.recordSize = sizeof(HeatMapRecord);
+        header.flags = flags;
+        return header;
+    }
+
+    std::ofstream out;
+    uint64_t count = 0;
+    uint32_t flags = 0;
+    uint64_t lastKey = 0;
+};
+
+// Read-only view of a heat-map file. Records are read straight out of the
+// mapping; nothing is copied on open, so opening takes the same time for
+// any file size. Open with RANDOM access for key lookups.
+class HeatMapFile {
+public:
+    // Returns false if the file can't be mapped or its header doesn't match
+    // this version of the format
+    bool open(const std::string& path, MappedFile::Access access = MappedFile::SEQUENTIAL) {
+        records = nullptr;
+        count = 0;
+        flags = 0;
+        if (!file.open(path, access)) return false;
+
+        std::string_view data = file.data();
+        if (data.size() < sizeof(HeatMapFileHeader)) return false;
+        const auto* header = reinterpret_cast<const HeatMapFileHeader*>(data.data());
+        if (std::memcmp(header->magic, HEAT_FILE_MAGIC, sizeof(header->magic)) != 0
+            || header->version != HEAT_FILE_VERSION
+            || header->recordSize != sizeof(HeatMapRecord))
+            return false;
+        if ((data.size() - sizeof(HeatMapFileHeader)) / sizeof(HeatMapRecord)
+            < header->recordCount)
+            return false; // truncated
+
+        records = reinterpret_cast<const HeatMapRecord*>(data.data() + sizeof(HeatMapFileHeader));
+        count = static_cast<size_t>(header->recordCount);
+        flags = header->flags;
+        return true;
+    }
+
+    size_t size() const { return count; }
+    bool sorted() const { return flags & HEAT_FILE_SORTED; }
+
+    // Heat maps stored for key, or nullptr if there are none (or the file
+    // isn't sorted). Zobrist keys are spread evenly, so interpolating
+    // between the keys at both ends of the range lands within a few records
+    // of the target and a lookup touches only a handful of pages. Every
+    // other step bisects instead, which bounds the worst case at twice a
+    // binary search.
+    const PackedHeatMaps* find(uint64_t key) const {
+        if (!sorted() || count == 0) return nullptr;
+        size_t lo = 0, hi = count; // the key, if present, is in [lo, hi)
+        for (bool bisect = false; hi - lo > 8; bisect = !bisect) {
+            uint64_t first = records[lo].key, last = records[hi - 1].key;
+            if (key < first || key > last) return nullptr;
+            size_t mid = lo + (hi - lo) / 2;
+            if (!bisect && last > first) {
+                unsigned __int128 offset = static_cast<unsigned __int128>(key - first)
+                                         * (hi - 1 - lo) / (last - first);
+                mid = lo + static_cast<size_t>(offset);
+            }
+            if (records[mid].key == key) return &records[mid].maps;
+            if (records[mid].key < key) lo = mid + 1;
+            else hi = mid;
+        }
+        for (size_t i = lo; i < hi; i++)
+            if (records[i].key == key) return &records[i].maps;
+        return nullptr;
+    }
+
+    const HeatMapRecord& operator[](size_t i) const { return records[i]; }
+    const HeatMapRecord* begin() const { return records; }
+    const HeatMapRecord* end() const { return records + count; }
+
+private:
+    MappedFile file;
+    const HeatMapRecord* records = nullptr;
+    size_t count = 0;
+    uint32_t flags = 0;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ============================================================================
+// MappedFile — read-only mapping of a whole file (POSIX mmap)
+//
+// SEQUENTIAL suits files that are scanned front to back and lets the kernel
+// read ahead; RANDOM suits lookup tables, where read-ahead would pull in
+// pages that are never touched.
+// ============================================================================
+
+class MappedFile {
+public:
+    enum Access { SEQUENTIAL, RANDOM };
+
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const std::string& path, Access access = SEQUENTIAL) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        size = static_cast<size_t>(st.st_size);
+        if (size > 0) {
+            void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                size = 0;
+                return false;
+            }
+            base = static_cast<const char*>(p);
+            madvise(p, size, access == RANDOM ? MADV_RANDOM : MADV_SEQUENTIAL);
+        }
+        ::close(fd); // the mapping stays valid after the descriptor is closed
+        return true;
+    }
+
+    void close() {
+        if (base) munmap(const_cast<char*>(base), size);
+        base = nullptr;
+        size = 0;
+    }
+
+    std::string_view data() const { return {base, size}; }
+
+private:
+    const char* base = nullptr;
+    size_t size = 0;
+};
@@ -0,0 +1,149 @@
+#include "board.hpp"
+#include "heatmap_file.hpp"
+#include "pgn.hpp"
+#include "work_stealing.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================================
+// openingdb — build the opening heat-map table from PGN game databases
+//
+//   openingdb [--plies N] [--min-games K] [--threads N] games.pgn... out.heat
+//
+// Every position in the first N plies (default 20) of every game is
+// counted, and those reached in at least K games (default 2) are written
+// with their heat maps to a sorted heat-map file. The game looks positions
+// up there by Zobrist key (chess --openings out.heat) instead of computing
+// them; the file is mmapped and searched in place, so it loads instantly
+// at any size.
+// ============================================================================
+
+struct OpeningEntry {
+    PackedPosition position;
+    uint32_t games = 0;
+};
+
+using OpeningCounts = std::unordered_map<uint64_t, OpeningEntry>;
+
+// Per-worker counts, padded so neighbouring workers never share a line
+struct alignas(64) OpeningWorker {
+    OpeningCounts counts;
+    std::vector<uint64_t> seen; // keys already counted for the current game
+    uint64_t games = 0;
+};
+
+void countGame(std::string_view game, int plies, OpeningWorker& worker) {
+    Board board;
+    std::string_view fen = pgnTag(game, "FEN");
+    if (!fen.empty() && !board.loadFEN(std::string(fen))) return;
+
+    worker.games++;
+    worker.seen.clear();
+    SanTokenizer tokens(game);
+    std::string_view san;
+    UndoInfo undo;
+    for (int ply = 0; ply <= plies; ply++) {
+        // A position repeated within one game still counts once for it
+        if (std::find(worker.seen.begin(), worker.seen.end(), board.key) == worker.seen.end()) {
+            worker.seen.push_back(board.key);
+            OpeningEntry& entry = worker.counts[board.key];
+            if (entry.games++ == 0) entry.position = board.pack();
+        }
+        Move m;
+        if (ply == plies || !tokens.next(san) || !sanToMove(board, san, m)) break;
+        board.makeMove(m, undo);
+    }
+}
+
+int main(int argc, char** argv) {
+    int threads = defaultThreadCount();
+    int plies = 20;
+    uint32_t minGames = 2;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--plies" && i + 1 < argc) plies = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--min-games" && i + 1 < argc)
+            minGames = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+        else paths.push_back(arg);
+    }
+    if (paths.size() < 2) {
+        std::cerr << "usage: openingdb [--plies N] [--min-games K] [--threads N] games.pgn... out.heat"
+                  << std::endl;
+        return 1;
+    }
+    std::string outPath = paths.back();
+    paths.pop_back();
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<OpeningWorker> workers(threads);
+    for (auto& path : paths) {
+        MappedFile file;
+        if (!file.open(path)) {
+            std::cerr << "Failed to read " << path << std::endl;
+            return 1;
+        }
+        streamPgnGames(file.data(), threads, [&](std::string_view game, int w) {
+            countGame(game, plies, workers[w]);
+        });
+    }
+
+    // Merge the workers' counts and keep the popular positions
+    OpeningCounts& total = workers[0].counts;
+    uint64_t games = workers[0].games;
+    for (size_t w = 1; w < workers.size(); w++) {
+        games += workers[w].games;
+        for (auto& [key, entry] : workers[w].counts) {
+            OpeningEntry& merged = total[key];
+            if (merged.games == 0) merged.position = entry.position;
+            merged.games += entry.games;
+        }
+        OpeningCounts().swap(workers[w].counts);
+    }
+    std::vector<HeatMapRecord> records;
+    std::vector<const OpeningEntry*> popular;
+    for (auto& [key, entry] : total) {
+        if (entry.games < minGames) continue;
+        records.push_back({key, {}});
+        popular.push_back(&entry);
+    }
+
+    parallelFor(records.size(), threads, [&](size_t i, int) {
+        Board board;
+        board.unpack(popular[i]->position);
+        computeHeatMaps(board, records[i].maps);
+    });
+    std::sort(records.begin(), records.end(),
+              [](const HeatMapRecord& a, const HeatMapRecord& b) { return a.key < b.key; });
+
+    HeatMapWriter writer;
+    if (!writer.open(outPath, HEAT_FILE_SORTED)) {
+        std::cerr << "Failed to write " << outPath << std::endl;
+        return 1;
+    }
+    for (auto& record : records) {
+        if (!writer.write(record.key, record.maps)) {
+            std::cerr << "Failed to write " << outPath << std::endl;
+            return 1;
+        }
+    }
+    if (!writer.close()) {
+        std::cerr << "Failed to write " << outPath << std::endl;
+        return 1;
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << games << " games, " << total.size() << " distinct positions, "
+              << records.size() << " written, " << elapsed << " s" << std::endl;
+    return 0;
+}
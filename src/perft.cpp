@@ -0,0 +1,358 @@
+#include "analysis_worker.hpp"
+#include "board.hpp"
+#include "heatmap_cache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// perft — headless move generation benchmark and correctness check
+//
+//   perft [--threads N] <depth> [fen]   divide counts for one position
+//   perft [--threads N] --suite         run the reference positions
+//   perft [--threads N] --cache-check   check HeatMapCache under contention
+//   perft --worker-check                check AnalysisWorker never loses a result
+//
+// The suite also fails if walking a position's tree allocates: move
+// generation, makeMove and unmakeMove must never touch the heap.
+// ============================================================================
+
+// Heap allocations made by the calling thread, counted by the operator new
+// replacements below
+thread_local uint64_t threadAllocations = 0;
+
+void* operator new(std::size_t size) {
+    threadAllocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+struct PerftCase {
+    const char* name;
+    const char* fen;
+    int depth;
+    uint64_t nodes;
+};
+
+// Published reference counts
+const PerftCase SUITE[] = {
+    {"start",              START_FEN, 5, 4865609},
+    {"kiwipete",           "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603},
+    {"position 3",         "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6, 11030083},
+    {"position 4",         "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333},
+    {"position 5",         "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487},
+    {"position 6",         "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594},
+    {"illegal ep 1",       "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1", 6, 1134888},
+    {"illegal ep 2",       "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1", 6, 1015133},
+    {"ep gives check",     "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 6, 1440467},
+    {"short castle check", "5k2/8/8/8/8/8/8/4K2R w K - 0 1", 6, 661072},
+    {"long castle check",  "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", 6, 803711},
+    {"castle rights",      "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1", 4, 1274206},
+    {"castle prevented",   "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 4, 1720476},
+    {"promote out of check", "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", 6, 3821001},
+    {"discovered check",   "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1", 5, 1004658},
+    {"promote to check",   "4k3/1P6/8/8/8/8/K7/8 w - - 0 1", 6, 217342},
+    {"underpromote to check", "8/P1k5/K7/8/8/8/8/8 w - - 0 1", 6, 92683},
+    {"self stalemate",     "K1k5/8/P7/8/8/8/8/8 w - - 0 1", 6, 2217},
+    {"stalemate and mate", "8/k1P5/8/1K6/8/8/8/8 w - - 0 1", 7, 567584},
+    {"mate and stalemate", "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", 4, 23527},
+};
+
+uint64_t perft(Board& board, int depth) {
+    MoveList moves;
+    board.getAllLegalMoves(moves);
+#ifdef CHESS_DEBUG_ATTACKS
+    assert(board.hasAnyLegalMove() == !moves.empty());
+#endif
+    if (depth <= 1) return moves.size();
+
+    uint64_t nodes = 0;
+    UndoInfo undo;
+    for (Move m : moves) {
+        board.makeMove(m, undo);
+        nodes += perft(board, depth - 1);
+        board.unmakeMove(m, undo);
+    }
+    return nodes;
+}
+
+// Count each root move's subtree, handing root moves out to worker threads.
+// Heap allocations made while walking the subtrees are added to allocations.
+std::vector<uint64_t> divide(const Board& board, int depth, int threads,
+                             std::atomic<uint64_t>* allocations = nullptr) {
+    MoveList roots;
+    board.getAllLegalMoves(roots);
+    std::vector<uint64_t> counts(roots.size(), 0);
+    std::atomic<size_t> next{0};
+
+    auto worker = [&]() {
+        Board local = board;
+        UndoInfo undo;
+        uint64_t allocationsBefore = threadAllocations;
+        for (size_t i = next++; i < roots.size(); i = next++) {
+            local.makeMove(roots[i], undo);
+            counts[i] = (depth <= 1) ? 1 : perft(local, depth - 1);
+            local.unmakeMove(roots[i], undo);
+        }
+        if (allocations) *allocations += threadAllocations - allocationsBefore;
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+    return counts;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int runDivide(const std::string& fen, int depth, int threads) {
+    Board board;
+    if (!board.loadFEN(fen)) {
+        std::cerr << "Invalid FEN: " << fen << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    MoveList roots;
+    board.getAllLegalMoves(roots);
+    std::vector<uint64_t> counts = divide(board, depth, threads);
+    double elapsed = secondsSince(start);
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < roots.size(); i++) {
+        std::cout << moveToUci(roots[i]) << ": " << counts[i] << "\n";
+        total += counts[i];
+    }
+    std::cout << "\nNodes: " << total << "\n"
+              << "Time:  " << elapsed * 1000.0 << " ms\n"
+              << "NPS:   " << static_cast<uint64_t>(total / (elapsed > 0 ? elapsed : 1e-9))
+              << std::endl;
+    return 0;
+}
+
+int runSuite(int threads) {
+    int failures = 0;
+    uint64_t totalNodes = 0;
+    auto suiteStart = std::chrono::steady_clock::now();
+
+    for (auto& tc : SUITE) {
+        Board board;
+        if (!board.loadFEN(tc.fen)) {
+            std::cerr << "Invalid FEN in suite: " << tc.fen << std::endl;
+            return 1;
+        }
+        auto start = std::chrono::steady_clock::now();
+        uint64_t nodes = 0;
+        std::atomic<uint64_t> allocations{0};
+        for (uint64_t n : divide(board, tc.depth, threads, &allocations)) nodes += n;
+        double elapsed = secondsSince(start);
+        totalNodes += nodes;
+
+        bool ok = (nodes == tc.nodes) && allocations == 0;
+        if (!ok) failures++;
+        std::cout << (ok ? "ok   " : "FAIL ") << tc.name << " depth " << tc.depth
+                  << ": " << nodes;
+        if (nodes != tc.nodes) std::cout << " (expected " << tc.nodes << ")";
+        if (allocations) std::cout << " (" << allocations << " heap allocations)";
+        std::cout << "  [" << elapsed * 1000.0 << " ms]\n";
+    }
+
+    double elapsed = secondsSince(suiteStart);
+    std::cout << "\nNodes: " << totalNodes << "\n"
+              << "NPS:   " << static_cast<uint64_t>(totalNodes / (elapsed > 0 ? elapsed : 1e-9))
+              << std::endl;
+    if (failures) {
+        std::cerr << failures << " perft position(s) FAILED" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Every thread walks the suite trees through one small shared HeatMapCache,
+// storing on a miss and comparing each hit with a fresh computation, so a
+// torn or misfiled entry shows up as a mismatch
+const int CACHE_CHECK_DEPTH = 3;
+
+void cacheWalk(Board& board, int depth, HeatMapCache& cache, uint64_t& positions,
+               uint64_t& mismatches) {
+    positions++;
+    PackedHeatMaps fresh, cached;
+    computeHeatMaps(board, fresh);
+    if (cache.probe(board.key, cached)) {
+        if (std::memcmp(&fresh, &cached, sizeof(fresh)) != 0) mismatches++;
+    } else {
+        cache.store(board.key, fresh);
+    }
+    if (depth == 0) return;
+
+    MoveList moves;
+    board.getAllLegalMoves(moves);
+    UndoInfo undo;
+    for (Move m : moves) {
+        board.makeMove(m, undo);
+        cacheWalk(board, depth - 1, cache, positions, mismatches);
+        board.unmakeMove(m, undo);
+    }
+}
+
+int runCacheCheck(int threads) {
+    HeatMapCache cache(1); // a few thousand slots, so threads keep overwriting each other
+    std::atomic<uint64_t> positions{0}, mismatches{0};
+    auto start = std::chrono::steady_clock::now();
+
+    for (auto& tc : SUITE) {
+        Board board;
+        if (!board.loadFEN(tc.fen)) {
+            std::cerr << "Invalid FEN in suite: " << tc.fen << std::endl;
+            return 1;
+        }
+        MoveList roots;
+        board.getAllLegalMoves(roots);
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            Board local = board;
+            UndoInfo undo;
+            uint64_t walked = 0, bad = 0;
+            for (size_t i = next++; i < roots.size(); i = next++) {
+                local.makeMove(roots[i], undo);
+                cacheWalk(local, CACHE_CHECK_DEPTH - 1, cache, walked, bad);
+                local.unmakeMove(roots[i], undo);
+            }
+            positions += walked;
+            mismatches += bad;
+        };
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threads; t++) pool.emplace_back(worker);
+        worker();
+        for (auto& th : pool) th.join();
+    }
+
+    std::cout << positions << " positions, " << cache.capacity() << " slots, "
+              << cache.hits() << " hits, " << cache.misses() << " misses, "
+              << mismatches << " mismatches  [" << secondsSince(start) * 1000.0 << " ms]"
+              << std::endl;
+    if (mismatches) {
+        std::cerr << "HeatMapCache returned maps that differ from a fresh computation" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Submits bursts of positions to an AnalysisWorker as fast as a UI could,
+// some with a pressure map, and fails if the last submit of a burst never
+// gets its result
+const int WORKER_CHECK_ROUNDS = 2000;
+
+int runWorkerCheck() {
+    std::vector<Board> positions;
+    for (auto& tc : SUITE) {
+        Board board;
+        if (!board.loadFEN(tc.fen)) {
+            std::cerr << "Invalid FEN in suite: " << tc.fen << std::endl;
+            return 1;
+        }
+        positions.push_back(board);
+        MoveList moves;
+        board.getAllLegalMoves(moves);
+        UndoInfo undo;
+        for (Move m : moves) {
+            board.makeMove(m, undo);
+            positions.push_back(board);
+            board.unmakeMove(m, undo);
+        }
+    }
+
+    AnalysisWorker worker;
+    std::mt19937 rng(1);
+    int lost = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < WORKER_CHECK_ROUNDS; round++) {
+        const Board* last = nullptr;
+        int depth = 0;
+        for (int burst = 1 + static_cast<int>(rng() % 8); burst > 0; burst--) {
+            last = &positions[rng() % positions.size()];
+            depth = (rng() % 4 == 0) ? 1 : 0;
+            worker.submit(*last, nullptr, depth);
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        for (;;) {
+            const PositionAnalysis* a = worker.latest();
+            if (a && a->key == last->key && (depth == 0 || a->hasPressure)) break;
+            if (std::chrono::steady_clock::now() > deadline) {
+                lost++;
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    std::cout << WORKER_CHECK_ROUNDS << " bursts, " << lost << " final results lost  ["
+              << secondsSince(start) * 1000.0 << " ms]" << std::endl;
+    if (lost) {
+        std::cerr << "AnalysisWorker never published the result of a final submit" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (threads < 1) threads = 1;
+    bool suite = false, cacheCheck = false, workerCheck = false;
+    std::vector<std::string> positional;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--suite") suite = true;
+        else if (arg == "--cache-check") cacheCheck = true;
+        else if (arg == "--worker-check") workerCheck = true;
+        else if (arg == "--threads" && i + 1 < argc) threads = std::max(1, std::atoi(argv[++i]));
+        else positional.push_back(arg);
+    }
+
+    if (suite) return runSuite(threads);
+    if (cacheCheck) return runCacheCheck(threads);
+    if (workerCheck) return runWorkerCheck();
+
+    if (positional.empty()) {
+        std::cerr << "usage: perft [--threads N] <depth> [fen]\n"
+                  << "       perft [--threads N] --suite\n"
+                  << "       perft [--threads N] --cache-check\n"
+                  << "       perft --worker-check" << std::endl;
+        return 1;
+    }
+    int depth = std::atoi(positional[0].c_str());
+    if (depth < 1) {
+        std::cerr << "Depth must be at least 1" << std::endl;
+        return 1;
+    }
+    std::string fen = START_FEN;
+    if (positional.size() > 1) {
+        fen.clear();
+        for (size_t i = 1; i < positional.size(); i++)
+            fen += (i > 1 ? " " : "") + positional[i];
+    }
+    return runDivide(fen, depth, threads);
+}
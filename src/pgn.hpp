@@ -0,0 +1,352 @@
+#pragma once
+
+#include "board.hpp"
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// PGN reading — memory-mapped input, zero-copy game scanning and movetext
+// tokenizing, and SAN resolution against the legal move generator. Every
+// game, tag and SAN token is a std::string_view into the mapped file.
+// ============================================================================
+
+inline bool isPgnSpace(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+// Hands out one game at a time. A game starts at a tag line that follows
+// movetext (or the start of the input).
+class PgnScanner {
+public:
+    explicit PgnScanner(std::string_view text) : text(text) {}
+
+    bool nextGame(std::string_view& game) {
+        size_t gameStart = std::string_view::npos;
+        bool sawMovetext = false;
+
+        while (pos < text.size()) {
+            size_t lineStart = pos;
+            size_t eol = text.find('\n', pos);
+            pos = (eol == std::string_view::npos) ? text.size() : eol + 1;
+
+            size_t first = lineStart;
+            while (first < pos && isPgnSpace(text[first])) first++;
+            if (first == pos) continue;
+
+            if (text[first] == '[') {
+                if (gameStart != std::string_view::npos && sawMovetext) {
+                    pos = lineStart; // this tag line opens the next game
+                    game = text.substr(gameStart, lineStart - gameStart);
+                    return true;
+                }
+                if (gameStart == std::string_view::npos) gameStart = lineStart;
+            } else {
+                if (gameStart == std::string_view::npos) gameStart = lineStart;
+                sawMovetext = true;
+            }
+        }
+        if (gameStart == std::string_view::npos) return false;
+        game = text.substr(gameStart);
+        return true;
+    }
+
+private:
+    std::string_view text;
+    size_t pos = 0;
+};
+
+// Value of a tag in the game's header section, or an empty view
+inline std::string_view pgnTag(std::string_view game, std::string_view name) {
+    size_t pos = 0;
+    while (pos < game.size()) {
+        while (pos < game.size() && isPgnSpace(game[pos])) pos++;
+        if (pos >= game.size() || game[pos] != '[') break;
+        size_t close = game.find(']', pos);
+        if (close == std::string_view::npos) break;
+        std::string_view line = game.substr(pos + 1, close - pos - 1);
+        pos = close + 1;
+
+        if (line.size() > name.size() && line.substr(0, name.size()) == name
+            && isPgnSpace(line[name.size()])) {
+            size_t q1 = line.find('"');
+            size_t q2 = (q1 == std::string_view::npos) ? q1 : line.find('"', q1 + 1);
+            if (q2 != std::string_view::npos) return line.substr(q1 + 1, q2 - q1 - 1);
+        }
+    }
+    return {};
+}
+
+// Yields the mainline SAN tokens of a game in order. Tags, comments,
+// variations, NAGs, move numbers and the result token are skipped.
+class SanTokenizer {
+public:
+    explicit SanTokenizer(std::string_view game) : text(game) {}
+
+    bool next(std::string_view& san) {
+        int variationDepth = 0;
+        while (pos < text.size()) {
+            char ch = text[pos];
+            if (isPgnSpace(ch)) { pos++; continue; }
+
+            if (ch == '[' && variationDepth == 0) {
+                skipPast(']');
+            } else if (ch == '{') {
+                skipPast('}');
+            } else if (ch == ';') {
+                skipPast('\n');
+            } else if (ch == '(') {
+                variationDepth++;
+                pos++;
+            } else if (ch == ')') {
+                if (variationDepth > 0) variationDepth--;
+                pos++;
+            } else {
+                size_t start = pos;
+                while (pos < text.size() && !isPgnSpace(text[pos]) && text[pos] != '{'
+                       && text[pos] != '(' && text[pos] != ')' && text[pos] != ';')
+                    pos++;
+                std::string_view token = text.substr(start, pos - start);
+                if (variationDepth > 0 || token[0] == '$') continue;
+
+                // Drop a leading move number such as "12." or "12..."
+                size_t skip = 0;
+                while (skip < token.size() && token[skip] >= '0' && token[skip] <= '9') skip++;
+                if (skip < token.size() && token[skip] == '.') {
+                    while (skip < token.size() && token[skip] == '.') skip++;
+                    token.remove_prefix(skip);
+                }
+                if (token.empty()) continue;
+                if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*") {
+                    pos = text.size();
+                    return false;
+                }
+                san = token;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    void skipPast(char close) {
+        size_t end = text.find(close, pos);
+        pos = (end == std::string_view::npos) ? text.size() : end + 1;
+    }
+
+    std::string_view text;
+    size_t pos = 0;
+};
+
+// Resolve a SAN move ("Nbd7", "exd6", "O-O", "e8=Q+") to the matching legal
+// move. Candidates are found by looking back from the destination square
+// and checked with the board's pin/check masks, so nothing is allocated.
+// Returns false if the text is malformed, illegal or ambiguous.
+inline bool sanToMove(const Board& board, std::string_view san, Move& out) {
+    while (!san.empty() && (san.back() == '+' || san.back() == '#'
+                            || san.back() == '!' || san.back() == '?'))
+        san.remove_suffix(1);
+    if (san.empty()) return false;
+
+    Color us = board.sideToMove;
+    int homeRow = (us == WHITE) ? 0 : 7;
+    LegalContext ctx = board.legalContext(us);
+
+    if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+        Piece king = (us == WHITE) ? W_KING : B_KING;
+        if (board.squares[homeRow][4] != king) return false;
+        int toCol = (san.size() == 3) ? 6 : 2;
+        MoveList kingMoves;
+        board.getLegalMoves(homeRow, 4, kingMoves);
+        for (Move m : kingMoves)
+            if (m.toCol() == toCol) {
+                out = m;
+                return true;
+            }
+        return false;
+    }
+
+    // Promotion suffix: "=Q" or a bare trailing piece letter
+    size_t len = san.size();
+    char promotionLetter = 0;
+    if (len >= 2 && san[len - 2] == '=') {
+        promotionLetter = san[len - 1];
+        len -= 2;
+    } else if (len >= 3 && std::string_view("QRBN").find(san[len - 1]) != std::string_view::npos
+               && san[len - 2] >= '1' && san[len - 2] <= '8') {
+        promotionLetter = san[len - 1];
+        len -= 1;
+    }
+    if (len < 2) return false;
+    Piece promotion = EMPTY;
+    switch (promotionLetter) {
+    case 0: break;
+    case 'Q': promotion = W_QUEEN; break;
+    case 'R': promotion = W_ROOK; break;
+    case 'B': promotion = W_BISHOP; break;
+    case 'N': promotion = W_KNIGHT; break;
+    default: return false;
+    }
+
+    int toCol = san[len - 2] - 'a';
+    int toRow = san[len - 1] - '1';
+    if (toCol < 0 || toCol > 7 || toRow < 0 || toRow > 7) return false;
+    int to = squareIndex(toRow, toCol);
+
+    size_t pos = 0;
+    Piece whitePiece = W_PAWN;
+    switch (san[0]) {
+    case 'N': whitePiece = W_KNIGHT; pos = 1; break;
+    case 'B': whitePiece = W_BISHOP; pos = 1; break;
+    case 'R': whitePiece = W_ROOK;   pos = 1; break;
+    case 'Q': whitePiece = W_QUEEN;  pos = 1; break;
+    case 'K': whitePiece = W_KING;   pos = 1; break;
+    default: break;
+    }
+    Piece piece = (us == WHITE) ? whitePiece
+                                : static_cast<Piece>(whitePiece + (B_PAWN - W_PAWN));
+
+    int fromCol = -1, fromRow = -1;
+    bool capture = false;
+    for (; pos < len - 2; pos++) {
+        char ch = san[pos];
+        if (ch >= 'a' && ch <= 'h') fromCol = ch - 'a';
+        else if (ch >= '1' && ch <= '8') fromRow = ch - '1';
+        else if (ch == 'x') capture = true;
+        else return false;
+    }
+
+    // Squares a piece of this type could have come from
+    Bitboard from = 0;
+    if (piece == W_PAWN || piece == B_PAWN) {
+        int dir = (us == WHITE) ? 1 : -1;
+        if (capture || fromCol >= 0) {
+            // A pawn capturing onto `to` stands where an enemy pawn on `to`
+            // would attack
+            from = TABLES.pawn[us == WHITE ? BLACK : WHITE][to];
+        } else if (board.squares[toRow][toCol] == EMPTY) {
+            int r1 = toRow - dir, r2 = toRow - 2 * dir;
+            if (r1 >= 0 && r1 < 8) {
+                if (board.squares[r1][toCol] == piece) from = squareBit(squareIndex(r1, toCol));
+                else if (board.squares[r1][toCol] == EMPTY && r2 == (us == WHITE ? 1 : 6))
+                    from = squareBit(squareIndex(r2, toCol));
+            }
+        }
+    } else {
+        from = pieceAttacks(piece, to, board.occupied);
+    }
+    from &= board.pieces[piece];
+
+    // Only a pawn reaching the last rank promotes, and it must. A missing
+    // piece letter is taken as a queen.
+    bool promotes = (piece == W_PAWN || piece == B_PAWN) && toRow == (us == WHITE ? 7 : 0);
+    if (promotion != EMPTY && !promotes) return false;
+    if (promotes && promotion == EMPTY) promotion = W_QUEEN;
+
+    int found = 0;
+    while (from) {
+        int sq = popLsb(from);
+        Move m(sq, to, promotion);
+        if (fromCol >= 0 && m.fromCol() != fromCol) continue;
+        if (fromRow >= 0 && m.fromRow() != fromRow) continue;
+
+        // Pawn captures need something to take, or the en passant square
+        if ((piece == W_PAWN || piece == B_PAWN) && m.fromCol() != toCol) {
+            bool enPassant = board.squares[toRow][toCol] == EMPTY
+                             && toCol == board.enPassantCol
+                             && toRow == (us == WHITE ? 5 : 2);
+            if (!enPassant && pieceColor(board.squares[toRow][toCol]) == us) continue;
+            if (!enPassant && board.squares[toRow][toCol] == EMPTY) continue;
+        } else if (pieceColor(board.squares[toRow][toCol]) == us) {
+            continue;
+        }
+        if (!board.isLegal(m, ctx)) continue;
+        out = m;
+        found++;
+    }
+    return found == 1;
+}
+
+// ============================================================================
+// Pipeline — one thread scans the input into batches of games while
+// `consumers` worker threads replay them. The bounded queue keeps the scanner
+// at most a few batches ahead, so memory stays flat however large the input.
+// ============================================================================
+
+class GameBatchQueue {
+public:
+    explicit GameBatchQueue(size_t capacity) : capacity(capacity) {}
+
+    void push(std::vector<std::string_view>&& batch) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [&] { return batches.size() < capacity; });
+        batches.push_back(std::move(batch));
+        notEmpty.notify_one();
+    }
+
+    // Returns false once the queue is closed and drained
+    bool pop(std::vector<std::string_view>& batch) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [&] { return !batches.empty() || closed; });
+        if (batches.empty()) return false;
+        batch = std::move(batches.front());
+        batches.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notEmpty.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable notEmpty, notFull;
+    std::deque<std::vector<std::string_view>> batches;
+    size_t capacity;
+    bool closed = false;
+};
+
+// Calls consume(game, worker) for every game in text, with worker in
+// [0, consumers). Games are handed out in batches to keep queue traffic low.
+template <class Consumer>
+void streamPgnGames(std::string_view text, int consumers, Consumer&& consume) {
+    const size_t BATCH_GAMES = 256;
+    consumers = std::max(1, consumers);
+    GameBatchQueue queue(static_cast<size_t>(consumers) * 4);
+
+    std::vector<std::thread> workers;
+    for (int w = 0; w < consumers; w++)
+        workers.emplace_back([&, w]() {
+            std::vector<std::string_view> batch;
+            while (queue.pop(batch))
+                for (auto game : batch) consume(game, w);
+        });
+
+    PgnScanner scanner(text);
+    std::vector<std::string_view> batch;
+    batch.reserve(BATCH_GAMES);
+    std::string_view game;
+    while (scanner.nextGame(game)) {
+        batch.push_back(game);
+        if (batch.size() == BATCH_GAMES) {
+            queue.push(std::move(batch));
+            batch = std::vector<std::string_view>();
+            batch.reserve(BATCH_GAMES);
+        }
+    }
+    if (!batch.empty()) queue.push(std::move(batch));
+    queue.close();
+    for (auto& th : workers) th.join();
+}
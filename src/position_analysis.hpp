@@ -0,0 +1,66 @@
+#pragma once
+
+#include "board.hpp"
+#include "heatmap_cache.hpp"
+#include "pressure.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// ============================================================================
+// PositionAnalysis — everything the UI derives from a position, computed once
+// when the position changes: both heat grids, check state, the side to move's
+// king square and the legal moves grouped by origin square. The look-ahead
+// pressure map is only filled in when asked for, after the rest.
+// ============================================================================
+
+struct PositionAnalysis {
+    bool valid = false;
+    uint64_t key = 0;            // Board::key of the analysed position
+    PackedHeatMaps heat{};
+    bool inCheck = false;        // side to move is in check
+    int kingRow = -1, kingCol = -1;
+
+    // Legal moves sorted by origin square; the moves from square sq are
+    // legalMoves[firstMove[sq]] up to legalMoves[firstMove[sq + 1]]
+    std::vector<Move> legalMoves;
+    std::array<uint16_t, 65> firstMove{};
+
+    bool hasPressure = false;
+    PressureMap pressure;
+
+    // heatMaps, if given, are the already computed maps of this position
+    void analyze(const Board& board, const PackedHeatMaps* heatMaps = nullptr) {
+        PROFILE_SCOPE("PositionAnalysis::analyze");
+        key = board.key;
+        hasPressure = false;
+        if (heatMaps) heat = *heatMaps;
+        else computeHeatMaps(board, heat);
+        inCheck = board.isInCheck(board.sideToMove);
+        auto [kr, kc] = board.findKing(board.sideToMove);
+        kingRow = kr;
+        kingCol = kc;
+
+        // Counting sort of the generator's output by origin square
+        MoveList moves;
+        board.getAllLegalMoves(moves);
+        std::array<uint16_t, 65> counts{};
+        for (Move m : moves) counts[m.from() + 1]++;
+        for (int sq = 0; sq < 64; sq++) counts[sq + 1] += counts[sq];
+        firstMove = counts;
+
+        legalMoves.resize(moves.size());
+        for (Move m : moves) legalMoves[counts[m.from()]++] = m;
+        valid = true;
+    }
+
+    bool isCurrentFor(const Board& board) const { return valid && key == board.key; }
+
+    const Move* movesFromBegin(int r, int c) const {
+        return legalMoves.data() + firstMove[squareIndex(r, c)];
+    }
+    const Move* movesFromEnd(int r, int c) const {
+        return legalMoves.data() + firstMove[squareIndex(r, c) + 1];
+    }
+};
@@ -0,0 +1,210 @@
+#pragma once
+
+#include "board.hpp"
+#include "heatmap_color.hpp"
+#include "profiler.hpp"
+#include "work_stealing.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// ============================================================================
+// Pressure map — attack counts averaged over the positions reachable in the
+// next few plies, rather than the static counts of the current position
+//
+// Every distinct position at ply 0..depth contributes its attack counts.
+// Counts are averaged per ply, so a ply with many positions carries no more
+// weight than one with few, and ply d is then weighted by decay^d. A value
+// of 1.5 for white on e4 means that, over the continuations considered,
+// white attacks e4 one and a half times on average.
+//
+// The tree is walked with makeMove/unmakeMove, whose incremental attack
+// counts make each visited position cheap to score. Transpositions (the
+// same position reached at the same ply by another move order) are walked
+// once, via a shared lock-free key set. Positions at SPLIT_PLY are shared
+// out to threads with parallelFor's work stealing.
+//
+// Profiling scopes are suppressed for the whole walk: timing every node's
+// move generation would cost more than the search itself, so a profile
+// shows the caller's scope around compute() instead.
+// ============================================================================
+
+struct PressureMap {
+    int depth = 0;
+    uint64_t positions = 0;  // distinct positions visited
+    float attack[2][64] = {}; // indexed by Color, then square
+};
+
+// Same colours as the attack map: blue where white has more pressure, red
+// where black does, alpha growing with the difference
+inline void pressureToRgba(const PressureMap& map, uint8_t rgba[256]) {
+    for (int sq = 0; sq < 64; sq++, rgba += 4) {
+        float diff = map.attack[WHITE][sq] - map.attack[BLACK][sq];
+        int alpha = std::min(static_cast<int>(std::fabs(diff) * ATTACK_ALPHA[1] + 0.5f), 230);
+        if (alpha == 0) {
+            rgba[0] = rgba[1] = rgba[2] = rgba[3] = 0;
+            continue;
+        }
+        const uint8_t* rgb = (diff > 0) ? HEAT_WHITE_RGB : HEAT_BLACK_RGB;
+        rgba[0] = rgb[0];
+        rgba[1] = rgb[1];
+        rgba[2] = rgb[2];
+        rgba[3] = static_cast<uint8_t>(alpha);
+    }
+}
+
+class PressureSearch {
+public:
+    static constexpr int MAX_DEPTH = 6;
+    static constexpr int SPLIT_PLY = 2;
+    // The transposition set never grows past this many keys (32 MB); once
+    // it is full, further positions are walked without deduplication
+    static constexpr size_t MAX_KEYS = size_t(1) << 22;
+
+    // Compute map for board, depth plies deep. stop() is polled during the
+    // walk; returns false if it asked to stop before the map was finished.
+    template <class Stop>
+    bool compute(const Board& board, int depth, double decay, int threads, PressureMap& map,
+                 Stop&& stop) {
+        PROFILE_SUPPRESS();
+        depth = std::max(0, std::min(depth, MAX_DEPTH));
+        MoveList rootMoves;
+        board.getAllLegalMoves(rootMoves);
+        prepareKeys(estimatePositions(rootMoves.size(), depth));
+
+        // Walk the first plies here, collecting the positions at the split ply
+        Totals mainTotals;
+        std::vector<Board> frontier;
+        int split = std::min(depth, SPLIT_PLY);
+        Board root = board;
+        gather(root, 0, split, mainTotals, frontier);
+
+        std::vector<Totals> totals(static_cast<size_t>(std::max(1, threads)));
+        std::atomic<bool> stopped{false};
+        parallelFor(frontier.size(), threads, [&](size_t i, int w) {
+            if (stopped.load(std::memory_order_relaxed)) return;
+            walk(frontier[i], split, depth, totals[w], stop, stopped);
+        });
+        if (stopped) return false;
+
+        for (auto& t : totals) mainTotals.add(t);
+        map = PressureMap();
+        map.depth = depth;
+        double weight = 1.0, weightSum = 0.0;
+        double sums[2][64] = {};
+        for (int ply = 0; ply <= depth; ply++, weight *= decay) {
+            uint64_t n = mainTotals.positions[ply];
+            if (n == 0) continue; // every line ended before this ply
+            map.positions += n;
+            weightSum += weight;
+            for (int c = WHITE; c <= BLACK; c++)
+                for (int sq = 0; sq < 64; sq++)
+                    sums[c][sq] += weight * mainTotals.attack[ply][c][sq] / n;
+        }
+        for (int c = WHITE; c <= BLACK; c++)
+            for (int sq = 0; sq < 64; sq++)
+                map.attack[c][sq] = static_cast<float>(sums[c][sq] / weightSum);
+        return true;
+    }
+
+private:
+    // Per-thread sums, merged at the end
+    struct Totals {
+        uint64_t attack[MAX_DEPTH + 1][2][64] = {};
+        uint64_t positions[MAX_DEPTH + 1] = {};
+
+        void add(const Board& b, int ply) {
+            positions[ply]++;
+            for (int c = WHITE; c <= BLACK; c++)
+                for (int sq = 0; sq < 64; sq++) attack[ply][c][sq] += b.attackCount[c][sq];
+        }
+
+        void add(const Totals& o) {
+            for (int ply = 0; ply <= MAX_DEPTH; ply++) {
+                positions[ply] += o.positions[ply];
+                for (int c = WHITE; c <= BLACK; c++)
+                    for (int sq = 0; sq < 64; sq++) attack[ply][c][sq] += o.attack[ply][c][sq];
+            }
+        }
+    };
+
+    // Open-addressed set of (key, ply); 0 marks an empty slot
+    std::unique_ptr<std::atomic<uint64_t>[]> keys;
+    size_t keyMask = 0;
+
+    static size_t estimatePositions(size_t branching, int depth) {
+        double estimate = std::pow(static_cast<double>(std::max<size_t>(branching, 2)), depth);
+        return static_cast<size_t>(std::min(estimate, static_cast<double>(MAX_KEYS)));
+    }
+
+    void prepareKeys(size_t positions) {
+        size_t capacity = 1 << 12;
+        while (capacity < positions * 2 && capacity < MAX_KEYS) capacity <<= 1;
+        if (capacity != keyMask + 1) {
+            keys.reset(new std::atomic<uint64_t>[capacity]);
+            keyMask = capacity - 1;
+        }
+        for (size_t i = 0; i <= keyMask; i++) keys[i].store(0, std::memory_order_relaxed);
+    }
+
+    // True the first time a position is seen at this ply
+    bool firstVisit(uint64_t key, int ply) {
+        // Mix the ply in, so the same position at two plies is two entries
+        uint64_t k = (key ^ (0x9E3779B97F4A7C15ULL * static_cast<uint64_t>(ply + 1))) | 1;
+        size_t slot = static_cast<size_t>(k) & keyMask;
+        for (int probe = 0; probe < 16; probe++, slot = (slot + 1) & keyMask) {
+            uint64_t seen = keys[slot].load(std::memory_order_relaxed);
+            if (seen == k) return false;
+            if (seen == 0) {
+                if (keys[slot].compare_exchange_strong(seen, k, std::memory_order_relaxed))
+                    return true;
+                if (seen == k) return false;
+            }
+        }
+        return true; // neighbourhood full: count it again rather than miss it
+    }
+
+    void gather(Board& b, int ply, int split, Totals& totals, std::vector<Board>& frontier) {
+        if (ply == split) {
+            frontier.push_back(b);
+            return;
+        }
+        if (!firstVisit(b.key, ply)) return;
+        totals.add(b, ply);
+        UndoInfo undo;
+        MoveList moves;
+        b.getAllLegalMoves(moves);
+        for (Move m : moves) {
+            b.makeMove(m, undo);
+            gather(b, ply + 1, split, totals, frontier);
+            b.unmakeMove(m, undo);
+        }
+    }
+
+    template <class Stop>
+    void walk(Board& b, int ply, int depth, Totals& totals, Stop& stop,
+              std::atomic<bool>& stopped) {
+        PROFILE_SUPPRESS(); // walk runs on parallelFor's threads too
+        if (!firstVisit(b.key, ply)) return;
+        totals.add(b, ply);
+        if (ply == depth) return;
+        if (stopped.load(std::memory_order_relaxed)) return;
+        if (stop()) {
+            stopped.store(true, std::memory_order_relaxed);
+            return;
+        }
+        UndoInfo undo;
+        MoveList moves;
+        b.getAllLegalMoves(moves);
+        for (Move m : moves) {
+            b.makeMove(m, undo);
+            walk(b, ply + 1, depth, totals, stop, stopped);
+            b.unmakeMove(m, undo);
+        }
+    }
+};
@@ -0,0 +1,314 @@
+#pragma once
+
+// ============================================================================
+// Profiler — scoped timers and counters, compiled in with -DCHESS_PROFILE
+//
+//   PROFILE_SCOPE("name")        time the rest of the enclosing block
+//   PROFILE_SUPPRESS()           time no scopes on this thread for the rest
+//                                of the enclosing block
+//   PROFILE_COUNT("name", n)     add n to a per-frame counter
+//   PROFILE_THREAD("name")       label the calling thread in traces
+//   PROFILE_FRAME()              close the current frame
+//
+// Each thread records into its own log, which PROFILE_FRAME() and trace
+// export merge, so timed scopes on different threads never share a lock.
+// Totals per frame feed the on-screen overlay; every timed scope and every
+// frame's counters are also kept (up to MAX_EVENTS) for export as a Chrome
+// trace_event file, viewable in chrome://tracing or Perfetto. Without
+// CHESS_PROFILE the macros expand to nothing. Names must be string
+// literals: they are stored and compared by pointer.
+// ============================================================================
+
+#ifdef CHESS_PROFILE
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Heap allocations so far. Counted by the program's own operator new, if it
+// replaces it; kept outside Profiler so counting never constructs anything.
+inline std::atomic<uint64_t> profileAllocations{0};
+
+// Nonzero while the calling thread is inside a PROFILE_SUPPRESS() block
+inline thread_local int profileSuppressed = 0;
+
+struct ProfileZone {
+    const char* name;
+    uint64_t calls = 0;
+    uint64_t ns = 0;
+};
+
+struct ProfileCounter {
+    const char* name;
+    uint64_t value = 0;
+};
+
+// Everything recorded between two PROFILE_FRAME()s, on all threads
+struct ProfileFrame {
+    uint64_t frameNs = 0;
+    uint64_t allocations = 0;
+    std::vector<ProfileZone> zones;
+    std::vector<ProfileCounter> counters;
+};
+
+class Profiler {
+public:
+    static constexpr size_t MAX_EVENTS = 1 << 20; // oldest are dropped first
+    // Events a thread holds between merges; past this, its newest are dropped
+    static constexpr size_t MAX_THREAD_EVENTS = 1 << 16;
+
+    static Profiler& instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    uint64_t now() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    // Scopes and counters go into the calling thread's own log. Its mutex is
+    // only ever contended by endFrame() or an export collecting the log.
+    void record(const char* name, uint64_t startNs, uint64_t endNs) {
+        ThreadLog& log = threadLog();
+        std::lock_guard<std::mutex> lock(log.mutex);
+        ProfileZone& zone = find(log.zones, name);
+        zone.calls++;
+        zone.ns += endNs - startNs;
+        if (log.events.size() < MAX_THREAD_EVENTS)
+            log.events.push_back({name, log.tid, startNs, endNs - startNs, false});
+    }
+
+    void count(const char* name, uint64_t n) {
+        ThreadLog& log = threadLog();
+        std::lock_guard<std::mutex> lock(log.mutex);
+        find(log.counters, name).value += n;
+    }
+
+    void nameThread(const char* name) {
+        uint32_t tid = threadId();
+        std::lock_guard<std::mutex> lock(mutex);
+        threadNames.push_back({name, tid});
+    }
+
+    // Close the current frame: every thread's log is merged in, it becomes
+    // lastFrame() and its counters go into the trace
+    void endFrame() {
+        uint64_t t = now();
+        uint64_t allocs = profileAllocations.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex);
+        for (ThreadLog* log : liveLogs) collect(*log);
+        current.frameNs = t - frameStart;
+        current.allocations = allocs - frameAllocations;
+        for (auto& c : current.counters) push({c.name, 0, t, c.value, true});
+        push({"heap allocations", 0, t, current.allocations, true});
+
+        last = std::move(current);
+        current = ProfileFrame();
+        // Keep the zone order stable from frame to frame for the overlay
+        for (auto& z : last.zones) current.zones.push_back({z.name, 0, 0});
+        for (auto& c : last.counters) current.counters.push_back({c.name, 0});
+        frameStart = t;
+        frameAllocations = allocs;
+    }
+
+    ProfileFrame lastFrame() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return last;
+    }
+
+    // Chrome trace_event JSON: one complete ("X") event per timed scope and
+    // one counter ("C") event per counter per frame
+    bool writeChromeTrace(const std::string& path) {
+        std::ofstream out(path);
+        if (!out) return false;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (ThreadLog* log : liveLogs) collect(*log);
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        auto separator = [&] {
+            out << (first ? "\n" : ",\n");
+            first = false;
+        };
+        for (auto& t : threadNames) {
+            separator();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t.tid
+                << ",\"args\":{\"name\":\"" << t.name << "\"}}";
+        }
+        for (auto& e : events) {
+            separator();
+            out << "{\"name\":\"" << e.name << "\",\"pid\":1,\"tid\":" << e.tid
+                << ",\"ts\":" << e.startNs / 1000.0;
+            if (e.counter)
+                out << ",\"ph\":\"C\",\"args\":{\"value\":" << e.value << "}}";
+            else
+                out << ",\"ph\":\"X\",\"dur\":" << e.value / 1000.0 << "}";
+        }
+        out << "\n]}\n";
+        return static_cast<bool>(out);
+    }
+
+private:
+    struct TraceEvent {
+        const char* name;
+        uint32_t tid;
+        uint64_t startNs;
+        uint64_t value;   // duration in ns, or the counter's value
+        bool counter;
+    };
+
+    struct ThreadName {
+        const char* name;
+        uint32_t tid;
+    };
+
+    // What one thread recorded since its log was last collected
+    struct ThreadLog {
+        std::mutex mutex;
+        uint32_t tid = 0;
+        std::vector<ProfileZone> zones;
+        std::vector<ProfileCounter> counters;
+        std::vector<TraceEvent> events;
+    };
+
+    // Owns the calling thread's log; hands it back, collected, when the
+    // thread exits, so short-lived worker threads reuse a few logs
+    struct LogHandle {
+        ThreadLog* log;
+        LogHandle() : log(instance().acquireLog()) {}
+        ~LogHandle() { instance().releaseLog(log); }
+    };
+
+    Profiler() : epoch(std::chrono::steady_clock::now()) {}
+
+    static uint32_t threadId() {
+        static std::atomic<uint32_t> nextId{1};
+        thread_local uint32_t id = nextId++;
+        return id;
+    }
+
+    static ThreadLog& threadLog() {
+        thread_local LogHandle handle;
+        return *handle.log;
+    }
+
+    template <class T>
+    static T& find(std::vector<T>& items, const char* name) {
+        for (auto& item : items)
+            if (item.name == name) return item;
+        items.push_back({name});
+        return items.back();
+    }
+
+    ThreadLog* acquireLog() {
+        uint32_t tid = threadId();
+        std::lock_guard<std::mutex> lock(mutex);
+        ThreadLog* log;
+        if (freeLogs.empty()) {
+            logs.push_back(std::make_unique<ThreadLog>());
+            log = logs.back().get();
+        } else {
+            log = freeLogs.back();
+            freeLogs.pop_back();
+        }
+        log->tid = tid;
+        liveLogs.push_back(log);
+        return log;
+    }
+
+    void releaseLog(ThreadLog* log) {
+        std::lock_guard<std::mutex> lock(mutex);
+        collect(*log);
+        liveLogs.erase(std::find(liveLogs.begin(), liveLogs.end(), log));
+        freeLogs.push_back(log);
+    }
+
+    // Move a thread's log into the current frame and the trace. The thread
+    // is held up only while its events are swapped out. Caller holds mutex.
+    void collect(ThreadLog& log) {
+        {
+            std::lock_guard<std::mutex> lock(log.mutex);
+            for (auto& z : log.zones) {
+                ProfileZone& zone = find(current.zones, z.name);
+                zone.calls += z.calls;
+                zone.ns += z.ns;
+            }
+            for (auto& c : log.counters) find(current.counters, c.name).value += c.value;
+            log.zones.clear();
+            log.counters.clear();
+            log.events.swap(collected);
+        }
+        for (auto& e : collected) push(e);
+        collected.clear();
+    }
+
+    void push(const TraceEvent& e) {
+        if (events.size() == MAX_EVENTS) events.pop_front();
+        events.push_back(e);
+    }
+
+    const std::chrono::steady_clock::time_point epoch;
+    mutable std::mutex mutex;
+    ProfileFrame current, last;
+    uint64_t frameStart = 0;
+    uint64_t frameAllocations = 0;
+    std::deque<TraceEvent> events;
+    std::vector<ThreadName> threadNames;
+    std::vector<std::unique_ptr<ThreadLog>> logs;
+    std::vector<ThreadLog*> liveLogs, freeLogs;
+    std::vector<TraceEvent> collected; // swapped with a log's events
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name)
+        : name(profileSuppressed ? nullptr : name),
+          start(this->name ? Profiler::instance().now() : 0) {}
+    ~ProfileScope() {
+        if (!name) return;
+        Profiler& profiler = Profiler::instance();
+        profiler.record(name, start, profiler.now());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name; // null when suppressed
+    uint64_t start;
+};
+
+// Scopes opened on this thread while one of these is alive are not timed
+class ProfileSuppress {
+public:
+    ProfileSuppress() { profileSuppressed++; }
+    ~ProfileSuppress() { profileSuppressed--; }
+
+    ProfileSuppress(const ProfileSuppress&) = delete;
+    ProfileSuppress& operator=(const ProfileSuppress&) = delete;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#define PROFILE_SUPPRESS() ProfileSuppress PROFILE_CONCAT(profileSuppress_, __LINE__)
+#define PROFILE_COUNT(name, n) Profiler::instance().count(name, n)
+#define PROFILE_THREAD(name) Profiler::instance().nameThread(name)
+#define PROFILE_FRAME() Profiler::instance().endFrame()
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_SUPPRESS() ((void)0)
+#define PROFILE_COUNT(name, n) ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+
+#endif
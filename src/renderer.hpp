@@ -0,0 +1,393 @@
+#pragma once
+
+#include "board.hpp"
+#include "board_style.hpp"
+#include "heatmap_color.hpp"
+#include "position_analysis.hpp"
+#include "profiler.hpp"
+#include "work_stealing.hpp"
+
+#ifdef CHESS_EMBED_ASSETS
+#include "embedded_assets.hpp" // generated by embed_assets; see the Makefile
+#endif
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Frames actually drawn versus redraw requests folded into a pending frame
+struct FrameStats {
+    uint64_t rendered = 0;
+    uint64_t skipped = 0;
+};
+
+// ============================================================================
+// Renderer Class — All SFML drawing (SFML 3.x API)
+// ============================================================================
+
+class Renderer {
+public:
+    static constexpr float TILE_SIZE = 80.f;
+    static constexpr float BOARD_PX = TILE_SIZE * 8;
+    static constexpr float STATUS_HEIGHT = 40.f;
+    static constexpr float TIMELINE_HEIGHT = 4.f;
+
+    // All 12 piece images packed into one texture: white pieces on the top
+    // row, black on the bottom, in Piece enum order
+    sf::Texture atlas;
+    sf::IntRect atlasRects[13]; // indexed by Piece enum
+    std::optional<sf::Font> font;
+
+#ifdef CHESS_EMBED_ASSETS
+    static constexpr const char* ASSET_SOURCE = "embedded";
+#else
+    static constexpr const char* ASSET_SOURCE = "files";
+#endif
+
+    // Built with CHESS_EMBED_ASSETS, the atlas arrives pre-decoded and the
+    // font (if one was embedded) is read in place, so no file is opened;
+    // otherwise the piece images are read from assets/ and the status bar
+    // uses the first system font found.
+    bool loadAssets() {
+        PROFILE_SCOPE("Renderer::loadAssets");
+#ifdef CHESS_EMBED_ASSETS
+        if (!loadEmbeddedAtlas()) {
+            std::cerr << "Failed to load embedded piece atlas" << std::endl;
+            return false;
+        }
+        sf::Font embeddedFont;
+        if (EMBEDDED_FONT_SIZE > 0 && embeddedFont.openFromMemory(EMBEDDED_FONT, EMBEDDED_FONT_SIZE))
+            font = std::move(embeddedFont);
+#else
+        if (!loadAtlasFromFiles()) return false;
+#endif
+        if (!font) loadSystemFont();
+        return true;
+    }
+
+#ifdef CHESS_EMBED_ASSETS
+    bool loadEmbeddedAtlas() {
+        sf::Image sheet({EMBEDDED_ATLAS_WIDTH, EMBEDDED_ATLAS_HEIGHT}, EMBEDDED_ATLAS_RGBA);
+        for (int p = W_PAWN; p <= B_QUEEN; p++) {
+            int x = static_cast<int>(atlasColumn(static_cast<Piece>(p)) * EMBEDDED_ATLAS_CELL);
+            int y = static_cast<int>(atlasRow(static_cast<Piece>(p)) * EMBEDDED_ATLAS_CELL);
+            atlasRects[p] = sf::IntRect({x, y}, {static_cast<int>(EMBEDDED_PIECE_SIZE[p][0]),
+                                                 static_cast<int>(EMBEDDED_PIECE_SIZE[p][1])});
+        }
+        return atlas.loadFromImage(sheet);
+    }
+#endif
+
+    // PNG decoding dominates startup, and the images are independent, so
+    // they are decoded in parallel
+    bool loadAtlasFromFiles() {
+        sf::Image images[13];
+        bool loaded[13] = {};
+        parallelFor(std::size(PIECE_IMAGE_FILES), defaultThreadCount(), [&](size_t i, int) {
+            const PieceImageFile& info = PIECE_IMAGE_FILES[i];
+            loaded[info.piece] = images[info.piece].loadFromFile(info.path);
+        });
+        unsigned cell = 0;
+        for (auto& info : PIECE_IMAGE_FILES) {
+            if (!loaded[info.piece]) {
+                std::cerr << "Failed to load " << info.path << std::endl;
+                return false;
+            }
+            auto sz = images[info.piece].getSize();
+            cell = std::max({cell, sz.x, sz.y});
+        }
+        if (!buildAtlas(images, cell)) {
+            std::cerr << "Failed to build piece atlas" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void loadSystemFont() {
+        const char* fontPaths[] = {
+            "/System/Library/Fonts/Helvetica.ttc",
+            "/System/Library/Fonts/SFNSMono.ttf",
+            "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+            "/usr/share/fonts/TTF/DejaVuSans.ttf",
+            "C:/Windows/Fonts/arial.ttf"
+        };
+        for (auto* fp : fontPaths) {
+            sf::Font tryFont;
+            if (tryFont.openFromFile(fp)) {
+                font = std::move(tryFont);
+                break;
+            }
+        }
+    }
+
+    bool buildAtlas(const sf::Image (&images)[13], unsigned cell) {
+        sf::Image sheet({cell * PIECE_ATLAS_COLUMNS, cell * PIECE_ATLAS_ROWS}, sf::Color::Transparent);
+        for (int p = W_PAWN; p <= B_QUEEN; p++) {
+            sf::Vector2u origin(atlasColumn(static_cast<Piece>(p)) * cell,
+                                atlasRow(static_cast<Piece>(p)) * cell);
+            if (!sheet.copy(images[p], origin)) return false;
+            auto sz = images[p].getSize();
+            atlasRects[p] = sf::IntRect({static_cast<int>(origin.x), static_cast<int>(origin.y)},
+                                        {static_cast<int>(sz.x), static_cast<int>(sz.y)});
+        }
+        return atlas.loadFromImage(sheet);
+    }
+
+    float rowToY(int row) const { return (7 - row) * TILE_SIZE; }
+    float colToX(int col) const { return col * TILE_SIZE; }
+    int yToRow(float y) const { return 7 - static_cast<int>(y / TILE_SIZE); }
+    int xToCol(float x) const { return static_cast<int>(x / TILE_SIZE); }
+
+    // Draw everything but the status bar: one call for the untextured layer
+    // (board, heat map, highlights, move markers), one for the pieces and
+    // one for a piece being dragged. The two layers are cached and only
+    // rebuilt when the position, its analysis, the view mode or the
+    // selection changes. analysis is null until the worker has finished
+    // with this position; heat maps and the check highlight wait for it.
+    void drawScene(sf::RenderTarget& target, const Board& board,
+                   const PositionAnalysis* analysis, ViewMode viewMode,
+                   int selRow, int selCol, const MoveList& legalMoves,
+                   bool dragging, float dragX, float dragY) {
+        PROFILE_SCOPE("Renderer::drawScene");
+        SceneKey scene{board.key, analysis != nullptr, analysis && analysis->hasPressure,
+                       viewMode, selRow, selCol, dragging};
+        if (!builtScene || !(*builtScene == scene)) {
+            PROFILE_SCOPE("Renderer::rebuildLayers");
+            rebuildLayers(board, analysis, viewMode, selRow, selCol, legalMoves, dragging);
+            builtScene = scene;
+        }
+
+        draw(target, overlayLayer);
+        draw(target, pieceLayer, &atlas);
+
+        if (dragging) {
+            sf::Vertex quad[6];
+            pieceQuad(board.squares[selRow][selCol], dragX, dragY, quad);
+            draw(target, quad, 6, sf::PrimitiveType::Triangles, &atlas);
+        }
+    }
+
+    void drawStatusBar(sf::RenderTarget& target, const Board& board,
+                       const PositionAnalysis* analysis, ViewMode viewMode,
+                       int ply, int plyCount, const FrameStats* stats = nullptr) {
+        PROFILE_SCOPE("Renderer::drawStatusBar");
+        sf::RectangleShape bar({BOARD_PX, STATUS_HEIGHT});
+        bar.setPosition({0, BOARD_PX});
+        bar.setFillColor(sf::Color(50, 50, 50));
+        draw(target, bar);
+
+        // Timeline along the bottom edge, filled up to the current ply
+        if (plyCount > 0) {
+            sf::RectangleShape progress({BOARD_PX * ply / plyCount, TIMELINE_HEIGHT});
+            progress.setPosition({0, BOARD_PX + STATUS_HEIGHT - TIMELINE_HEIGHT});
+            progress.setFillColor(sf::Color(200, 170, 80));
+            draw(target, progress);
+        }
+
+        if (!font) return;
+
+        std::string text;
+        if (board.gameOver) {
+            text = board.resultText();
+        } else {
+            text = (board.sideToMove == WHITE) ? "White to move" : "Black to move";
+            if (analysis && analysis->inCheck)
+                text += " -- CHECK!";
+        }
+        if (plyCount > 0)
+            text += "  (" + std::to_string(ply) + "/" + std::to_string(plyCount) + ")";
+        if (viewMode == VIEW_ATTACK)
+            text += "  [Attack Map]";
+        else if (viewMode == VIEW_DEFENDER)
+            text += "  [Defender Map]";
+        else if (viewMode == VIEW_PRESSURE)
+            text += (analysis && analysis->hasPressure)
+                        ? "  [Pressure " + std::to_string(analysis->pressure.depth) + " plies]"
+                        : std::string("  [Pressure: searching]");
+        sf::Text label(*font, text, 20);
+        label.setPosition({10.f, BOARD_PX + 8.f});
+        label.setFillColor(sf::Color::White);
+        draw(target, label);
+
+        if (stats) {
+            sf::Text counters(*font, "drawn " + std::to_string(stats->rendered + 1)
+                                     + " / skipped " + std::to_string(stats->skipped), 14);
+            counters.setPosition({BOARD_PX - counters.getLocalBounds().size.x - 10.f,
+                                  BOARD_PX + 12.f});
+            counters.setFillColor(sf::Color(170, 170, 170));
+            draw(target, counters);
+        }
+    }
+
+#ifdef CHESS_PROFILE
+    // The profiler's last closed frame: its length, heap allocations and
+    // counters, then time and call count per timed scope, over the top left
+    // of the board
+    void drawProfileOverlay(sf::RenderTarget& target, const ProfileFrame& frame) {
+        if (!font) return;
+        char line[96];
+        std::snprintf(line, sizeof(line), "frame %7.2f ms   allocs %llu",
+                      frame.frameNs / 1e6, static_cast<unsigned long long>(frame.allocations));
+        std::string text = line;
+        for (auto& c : frame.counters) {
+            std::snprintf(line, sizeof(line), "\n%-28s %8llu", c.name,
+                          static_cast<unsigned long long>(c.value));
+            text += line;
+        }
+        for (auto& z : frame.zones) {
+            std::snprintf(line, sizeof(line), "\n%-28s %5llu x %7.3f ms", z.name,
+                          static_cast<unsigned long long>(z.calls), z.ns / 1e6);
+            text += line;
+        }
+
+        sf::Text label(*font, text, 13);
+        label.setPosition({8.f, 6.f});
+        label.setFillColor(sf::Color::White);
+        sf::Vector2f size = label.getLocalBounds().size;
+        sf::RectangleShape panel({size.x + 12.f, size.y + 14.f});
+        panel.setFillColor(sf::Color(0, 0, 0, 170));
+        draw(target, panel);
+        draw(target, label);
+    }
+#endif
+
+private:
+    // Every draw call goes through here so the profiler can count them
+    template <class... Args>
+    static void draw(sf::RenderTarget& target, Args&&... args) {
+        PROFILE_COUNT("draw calls", 1);
+        target.draw(std::forward<Args>(args)...);
+    }
+
+    struct SceneKey {
+        uint64_t boardKey;
+        bool analysed;
+        bool pressure;
+        ViewMode viewMode;
+        int selRow, selCol;
+        bool dragging;
+
+        bool operator==(const SceneKey& o) const {
+            return boardKey == o.boardKey && analysed == o.analysed && pressure == o.pressure
+                && viewMode == o.viewMode && selRow == o.selRow
+                && selCol == o.selCol && dragging == o.dragging;
+        }
+    };
+
+    sf::VertexArray overlayLayer{sf::PrimitiveType::Triangles};
+    sf::VertexArray pieceLayer{sf::PrimitiveType::Triangles};
+    std::optional<SceneKey> builtScene;
+
+    void rebuildLayers(const Board& board, const PositionAnalysis* analysis, ViewMode viewMode,
+                       int selRow, int selCol, const MoveList& legalMoves,
+                       bool dragging) {
+        overlayLayer.clear();
+        pieceLayer.clear();
+
+        for (int row = 0; row < 8; row++)
+            for (int col = 0; col < 8; col++) {
+                appendRect(overlayLayer, colToX(col), rowToY(row), TILE_SIZE, TILE_SIZE,
+                           toColor(isLightSquare(row, col) ? LIGHT_SQUARE_COLOR
+                                                           : DARK_SQUARE_COLOR));
+            }
+
+        bool pressureShown = viewMode == VIEW_PRESSURE && analysis && analysis->hasPressure;
+        if (analysis && (viewMode == VIEW_ATTACK || viewMode == VIEW_DEFENDER || pressureShown)) {
+            uint8_t rgba[256];
+            if (viewMode == VIEW_ATTACK)
+                attackHeatToRgba(analysis->heat, rgba);
+            else if (viewMode == VIEW_DEFENDER)
+                defenderHeatToRgba(analysis->heat, board.colors[WHITE], board.colors[BLACK], rgba);
+            else
+                pressureToRgba(analysis->pressure, rgba);
+            for (int sq = 0; sq < 64; sq++) {
+                const uint8_t* px = rgba + sq * 4;
+                if (px[3] == 0) continue;
+                appendRect(overlayLayer, colToX(sq % 8), rowToY(sq / 8), TILE_SIZE, TILE_SIZE,
+                           sf::Color(px[0], px[1], px[2], px[3]));
+            }
+        }
+
+        if (selRow >= 0)
+            appendRect(overlayLayer, colToX(selCol), rowToY(selRow), TILE_SIZE, TILE_SIZE,
+                       toColor(SELECTED_COLOR));
+
+        if (!board.gameOver && analysis && analysis->inCheck)
+            appendRect(overlayLayer, colToX(analysis->kingCol), rowToY(analysis->kingRow),
+                       TILE_SIZE, TILE_SIZE, toColor(CHECK_COLOR));
+
+        // Captures get a ring around the target, quiet moves a dot. The four
+        // promotions to a square share one marker.
+        const sf::Color marker = toColor(MOVE_MARKER_COLOR);
+        for (Move m : legalMoves) {
+            if (m.promotion() != EMPTY && m.promotion() != W_QUEEN) continue;
+            float cx = colToX(m.toCol()) + TILE_SIZE / 2;
+            float cy = rowToY(m.toRow()) + TILE_SIZE / 2;
+            if (board.squares[m.toRow()][m.toCol()] != EMPTY)
+                appendRing(overlayLayer, cx, cy, TILE_SIZE / 2 - 4, TILE_SIZE / 2, marker);
+            else
+                appendRing(overlayLayer, cx, cy, 0, 10, marker);
+        }
+
+        sf::Vertex quad[6];
+        for (int row = 0; row < 8; row++)
+            for (int col = 0; col < 8; col++) {
+                Piece p = board.squares[row][col];
+                if (p == EMPTY || (dragging && row == selRow && col == selCol)) continue;
+                pieceQuad(p, colToX(col), rowToY(row), quad);
+                for (auto& v : quad) pieceLayer.append(v);
+            }
+    }
+
+    static sf::Color toColor(StyleColor c) { return sf::Color(c.r, c.g, c.b, c.a); }
+
+    static void appendRect(sf::VertexArray& va, float x, float y, float w, float h,
+                           sf::Color color) {
+        sf::Vector2f a(x, y), b(x + w, y), c(x + w, y + h), d(x, y + h);
+        for (auto& pos : {a, b, c, a, c, d})
+            va.append(sf::Vertex{pos, color, {}});
+    }
+
+    // Annulus between two radii as triangles; inner = 0 gives a filled disc
+    static void appendRing(sf::VertexArray& va, float cx, float cy, float inner, float outer,
+                           sf::Color color) {
+        const int SEGMENTS = 30;
+        const float STEP = 2 * 3.14159265f / SEGMENTS;
+        for (int i = 0; i < SEGMENTS; i++) {
+            float a0 = i * STEP, a1 = (i + 1) * STEP;
+            sf::Vector2f o0(cx + outer * std::cos(a0), cy + outer * std::sin(a0));
+            sf::Vector2f o1(cx + outer * std::cos(a1), cy + outer * std::sin(a1));
+            sf::Vector2f i0(cx + inner * std::cos(a0), cy + inner * std::sin(a0));
+            sf::Vector2f i1(cx + inner * std::cos(a1), cy + inner * std::sin(a1));
+            va.append(sf::Vertex{o0, color, {}});
+            va.append(sf::Vertex{o1, color, {}});
+            va.append(sf::Vertex{i0, color, {}});
+            if (inner > 0) {
+                va.append(sf::Vertex{i0, color, {}});
+                va.append(sf::Vertex{o1, color, {}});
+                va.append(sf::Vertex{i1, color, {}});
+            }
+        }
+    }
+
+    // Two triangles covering one tile at (x, y), textured from the atlas
+    void pieceQuad(Piece p, float x, float y, sf::Vertex (&quad)[6]) const {
+        const sf::IntRect& r = atlasRects[p];
+        float u0 = static_cast<float>(r.position.x), v0 = static_cast<float>(r.position.y);
+        float u1 = u0 + r.size.x, v1 = v0 + r.size.y;
+        sf::Vertex tl{{x, y}, sf::Color::White, {u0, v0}};
+        sf::Vertex tr{{x + TILE_SIZE, y}, sf::Color::White, {u1, v0}};
+        sf::Vertex br{{x + TILE_SIZE, y + TILE_SIZE}, sf::Color::White, {u1, v1}};
+        sf::Vertex bl{{x, y + TILE_SIZE}, sf::Color::White, {u0, v1}};
+        quad[0] = tl; quad[1] = tr; quad[2] = br;
+        quad[3] = tl; quad[4] = br; quad[5] = bl;
+    }
+};
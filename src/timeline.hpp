@@ -0,0 +1,214 @@
+#pragma once
+
+#include "board.hpp"
+#include "heatmap_cache.hpp"
+#include "heatmap_file.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+// ============================================================================
+// GameTimeline — the full move history of a game, with unlimited undo/redo
+// and random access to any ply.
+//
+// Each ply is stored as an 8-byte MoveDelta, enough to play the move forward
+// or take it back. Every KEYFRAME_INTERVAL plies the position is kept as
+// well, as a 40-byte PackedPosition, so seeking restores a snapshot and
+// replays from there. The snapshot is taken from before the last capture or
+// pawn move, so the replay also rebuilds the KeyHistory that repetitions
+// are detected from. Heat maps are cached per ply
+// once computed (off the UI thread, by whoever owns the timeline), so
+// scrubbing back over a game doesn't recompute them, and can come from a
+// precomputed opening table instead of being computed.
+// ============================================================================
+
+struct MoveDelta {
+    Move move;             // from, to and promotion piece
+    uint8_t moved;         // piece that left `from` (the pawn on promotion)
+    uint8_t captured;      // EMPTY if none; the taken pawn for en passant
+    uint8_t castling;      // castle rights before the move
+    int8_t enPassantCol;   // en passant file before the move, -1 if none
+    uint16_t halfmoveClock; // halfmove clock before the move
+};
+
+class GameTimeline {
+public:
+    static constexpr int KEYFRAME_INTERVAL = 32;
+
+    GameTimeline() { reset(Board()); }
+
+    // Start a new history from the given position
+    void reset(const Board& start) {
+        current = start;
+        history.clear();
+        currentPly = 0;
+        historyStart = 0;
+        deltas.clear();
+        keyframes.assign(1, start.pack());
+        heatCache.clear();
+        heatCached.clear();
+    }
+
+    const Board& board() const { return current; }
+    int ply() const { return currentPly; }
+    int length() const { return static_cast<int>(deltas.size()); }
+
+    // Play m from the current ply. Moves after the current ply (the redo
+    // history) are discarded first.
+    void play(Move m) {
+        truncate(currentPly);
+        UndoInfo undo;
+        history.push(current.key);
+        current.makeMove(m, undo);
+        current.updateGameOver(&history);
+
+        MoveDelta delta;
+        delta.move = m;
+        delta.moved = static_cast<uint8_t>(undo.moved);
+        delta.captured = static_cast<uint8_t>(undo.captured);
+        delta.castling = undo.castling;
+        delta.enPassantCol = undo.enPassantCol;
+        delta.halfmoveClock = undo.halfmoveClock;
+        deltas.push_back(delta);
+        currentPly++;
+
+        if (currentPly % KEYFRAME_INTERVAL == 0)
+            keyframes.push_back(current.pack());
+    }
+
+    bool canUndo() const { return currentPly > 0; }
+    bool canRedo() const { return currentPly < length(); }
+
+    bool undo() {
+        if (!canUndo()) return false;
+        stepBack();
+        keepHistoryComplete();
+        current.updateGameOver(&history);
+        return true;
+    }
+
+    bool redo() {
+        if (!canRedo()) return false;
+        stepForward();
+        current.updateGameOver(&history);
+        return true;
+    }
+
+    // Move to any ply in [0, length()], either by stepping from the current
+    // ply or by restoring a keyframe, whichever looks like fewer moves
+    void seek(int target) {
+        target = std::max(0, std::min(target, length()));
+        if (target == currentPly) return;
+
+        if (std::abs(target - currentPly) > target % KEYFRAME_INTERVAL) {
+            restore(target);
+        } else {
+            while (currentPly < target) stepForward();
+            while (currentPly > target) stepBack();
+            keepHistoryComplete();
+        }
+        current.updateGameOver(&history);
+    }
+
+    // Look positions up in this sorted heat-map file before computing their
+    // maps; nullptr turns the lookups off. The file must outlive the timeline.
+    void useHeatMapTable(const HeatMapFile* table) { heatTable = table; }
+
+    // Heat maps of the current position if they are already known, from the
+    // per-ply cache or the opening table; nullptr if they still have to be
+    // computed. Never computes them, so the UI thread can call it freely.
+    const PackedHeatMaps* knownHeatMaps() {
+        if (!heatCachedAt(currentPly)) {
+            const PackedHeatMaps* stored = heatTable ? heatTable->find(current.key) : nullptr;
+            if (!stored) return nullptr;
+            cacheHeatMaps(*stored);
+        }
+        return &heatCache[currentPly];
+    }
+
+    // Keep maps computed elsewhere (by the analysis worker) for the current ply
+    void cacheHeatMaps(const PackedHeatMaps& maps) {
+        if (heatCache.size() <= static_cast<size_t>(currentPly)) {
+            heatCache.resize(currentPly + 1);
+            heatCached.resize(currentPly + 1, false);
+        }
+        heatCache[currentPly] = maps;
+        heatCached[currentPly] = true;
+    }
+
+    bool heatCachedAt(int ply) const {
+        return static_cast<size_t>(ply) < heatCached.size() && heatCached[ply];
+    }
+
+    // History memory excluding the heat-map cache
+    size_t historyBytes() const {
+        return deltas.size() * sizeof(MoveDelta) + keyframes.size() * sizeof(PackedPosition);
+    }
+
+private:
+    // Reach target from the keyframe before its last capture or pawn move.
+    // A keyframe's own halfmove clock says how far back that move can be.
+    void restore(int target) {
+        int frame = target / KEYFRAME_INTERVAL;
+        current.unpack(keyframes[frame]);
+        int lookBack = current.halfmoveClock;
+        if (lookBack > 0 && frame > 0) {
+            frame = std::max(0, frame * KEYFRAME_INTERVAL - lookBack) / KEYFRAME_INTERVAL;
+            current.unpack(keyframes[frame]);
+        }
+        currentPly = historyStart = frame * KEYFRAME_INTERVAL;
+        history.clear();
+        while (currentPly < target) stepForward();
+    }
+
+    // After stepping back, the key history may no longer reach the last
+    // capture or pawn move; replay from a keyframe if so
+    void keepHistoryComplete() {
+        if (historyStart > std::max(0, currentPly - static_cast<int>(current.halfmoveClock)))
+            restore(currentPly);
+    }
+
+    void stepForward() {
+        UndoInfo undo;
+        history.push(current.key);
+        current.makeMove(deltas[currentPly].move, undo);
+        currentPly++;
+    }
+
+    void stepBack() {
+        currentPly--;
+        const MoveDelta& delta = deltas[currentPly];
+        UndoInfo undo;
+        undo.moved = static_cast<Piece>(delta.moved);
+        undo.captured = static_cast<Piece>(delta.captured);
+        undo.enPassantCol = delta.enPassantCol;
+        undo.castling = delta.castling;
+        undo.halfmoveClock = delta.halfmoveClock;
+        undo.key = 0;
+        current.unmakeMove(delta.move, undo);
+        current.key = current.computeKey(); // keys aren't stored per ply
+        history.pop();
+    }
+
+    // Drop everything after ply `end`
+    void truncate(int end) {
+        deltas.resize(end);
+        keyframes.resize(end / KEYFRAME_INTERVAL + 1);
+        if (heatCache.size() > static_cast<size_t>(end) + 1) {
+            heatCache.resize(end + 1);
+            heatCached.resize(end + 1);
+        }
+    }
+
+    Board current;
+    int currentPly = 0;
+    KeyHistory history;   // keys of the plies from historyStart up to the current one
+    int historyStart = 0; // first ply in history
+    std::vector<MoveDelta> deltas;        // deltas[i] takes ply i to ply i + 1
+    std::vector<PackedPosition> keyframes; // keyframes[k] is the position at ply k * KEYFRAME_INTERVAL
+    std::vector<PackedHeatMaps> heatCache; // indexed by ply
+    std::vector<bool> heatCached;
+    const HeatMapFile* heatTable = nullptr;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// ============================================================================
+// TripleBuffer — hands the newest value from one writer thread to one reader
+// thread without locks or waiting.
+//
+// The writer fills its private back buffer and publishes it by swapping it
+// with the shared middle buffer; the reader swaps the middle buffer for its
+// front buffer when a fresh one is there. Each side always owns a buffer of
+// its own, so neither ever waits for the other, and values the reader never
+// picked up are simply overwritten.
+// ============================================================================
+
+template <class T>
+class TripleBuffer {
+public:
+    // Writer side: the buffer to fill, then publish() it
+    T& writeBuffer() { return buffers[back]; }
+
+    void publish() {
+        uint8_t old = middle.exchange(static_cast<uint8_t>(back | FRESH),
+                                      std::memory_order_acq_rel);
+        back = old & INDEX;
+    }
+
+    // Reader side: take the newest published buffer if there is one.
+    // Returns true if readBuffer() changed.
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        uint8_t old = middle.exchange(front, std::memory_order_acq_rel);
+        front = old & INDEX;
+        return true;
+    }
+
+    const T& readBuffer() const { return buffers[front]; }
+
+private:
+    static constexpr uint8_t INDEX = 3;
+    static constexpr uint8_t FRESH = 4; // middle holds a value not yet read
+
+    T buffers[3];
+    uint8_t back = 0;                        // owned by the writer
+    alignas(64) std::atomic<uint8_t> middle{1};
+    alignas(64) uint8_t front = 2;           // owned by the reader
+};
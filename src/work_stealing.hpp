@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// Work-stealing parallel loop
+//
+// Each worker owns a contiguous slice of the index range, packed into one
+// atomic word as [begin, end). The owner takes items from the front of its
+// slice; a worker whose slice runs dry steals the back half of another
+// worker's slice with a single CAS. Uneven items (long games, deep subtrees)
+// therefore rebalance without a shared queue or any locks.
+// ============================================================================
+
+class WorkStealingRanges {
+public:
+    WorkStealingRanges(size_t count, int workers)
+        : slots(new Slot[workers]), workerCount(workers) {
+        for (int w = 0; w < workers; w++) {
+            uint32_t begin = static_cast<uint32_t>(count * w / workers);
+            uint32_t end = static_cast<uint32_t>(count * (w + 1) / workers);
+            slots[w].range.store(pack(begin, end), std::memory_order_relaxed);
+        }
+    }
+
+    // Next index for worker w, stealing when its own slice is empty.
+    // Returns false once no slice has work left to hand out.
+    bool next(int w, size_t& index) {
+        for (;;) {
+            if (popFront(w, index)) return true;
+            if (!steal(w)) return false;
+        }
+    }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> range{0};
+    };
+
+    static uint64_t pack(uint32_t begin, uint32_t end) {
+        return (static_cast<uint64_t>(begin) << 32) | end;
+    }
+    static uint32_t beginOf(uint64_t r) { return static_cast<uint32_t>(r >> 32); }
+    static uint32_t endOf(uint64_t r) { return static_cast<uint32_t>(r); }
+
+    bool popFront(int w, size_t& index) {
+        std::atomic<uint64_t>& range = slots[w].range;
+        uint64_t r = range.load(std::memory_order_relaxed);
+        while (beginOf(r) < endOf(r)) {
+            if (range.compare_exchange_weak(r, pack(beginOf(r) + 1, endOf(r)),
+                                            std::memory_order_relaxed)) {
+                index = beginOf(r);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Move the back half of the fullest other slice into worker w's slice
+    bool steal(int w) {
+        for (;;) {
+            int victim = -1;
+            uint32_t most = 1; // a single remaining item stays with its owner
+            uint64_t seen = 0;
+            for (int v = 0; v < workerCount; v++) {
+                if (v == w) continue;
+                uint64_t r = slots[v].range.load(std::memory_order_relaxed);
+                uint32_t left = endOf(r) > beginOf(r) ? endOf(r) - beginOf(r) : 0;
+                if (left > most) { most = left; victim = v; seen = r; }
+            }
+            if (victim < 0) return false;
+
+            uint32_t begin = beginOf(seen), end = endOf(seen);
+            uint32_t mid = begin + (end - begin) / 2;
+            if (slots[victim].range.compare_exchange_strong(seen, pack(begin, mid),
+                                                            std::memory_order_relaxed)) {
+                slots[w].range.store(pack(mid, end), std::memory_order_relaxed);
+                return true;
+            }
+            // Lost a race with the owner or another thief; look again
+        }
+    }
+
+    std::unique_ptr<Slot[]> slots;
+    int workerCount;
+};
+
+inline int defaultThreadCount() {
+    int n = static_cast<int>(std::thread::hardware_concurrency());
+    return n > 0 ? n : 1;
+}
+
+// Run body(index, worker) for every index in [0, count) on `threads` threads.
+// The calling thread acts as worker 0.
+template <class Body>
+void parallelFor(size_t count, int threads, Body&& body) {
+    threads = std::max(1, std::min<int>(threads, static_cast<int>(std::max<size_t>(count, 1))));
+    WorkStealingRanges ranges(count, threads);
+
+    auto run = [&](int w) {
+        size_t index;
+        while (ranges.next(w, index)) body(index, w);
+    };
+
+    std::vector<std::thread> pool;
+    for (int w = 1; w < threads; w++) pool.emplace_back(run, w);
+    run(0);
+    for (auto& th : pool) th.join();
+}